@@ -25,6 +25,8 @@
  */
 
 #include <future>
+#include <thread>
+#include <algorithm>
 #include <iostream>
 
 #include "Opts.h"
@@ -57,7 +59,16 @@ const Opts::OptsType optList
     { 'd', "duration",  "seconds",  "Maximum length of each side." },
     { 'e', "even",      NULL,       "Require an even number of sides." },
     { 'b', "boxes",     "count",    "Maximum number of containers (sides)." },
+    { 'r', "range",     "min..max", "Split across each number of sides in a range." },
     { 's', "shuffle",   NULL,       "Re-order tracks for optimal fit." },
+    { 'j', "jobs",      "count",    "Number of threads to use." },
+    { 'n', "engine",    "name",     "Shuffle engine to use, either finder or ckk." },
+    { 'm', "memory",    "megabytes","Memory for the finder transposition table." },
+    { 'q', "target",    "seconds",  "Stop shuffling once the deviation is this low." },
+    { 'g', "gap",       "seconds",  "Stop shuffling once this close to the lowest possible deviation." },
+    { 'l', "stream",    NULL,       "Write each better shuffle as a line of JSON when found." },
+    { 'k', "checkpoint","file",     "Checkpoint file used to save and resume shuffling." },
+    { 'u', "resume",    NULL,       "Resume shuffling from the checkpoint file." },
     { 'p', "plain",     NULL,       "Display lengths in seconds instead of hh:mm:ss." },
     { 'c', "csv",       NULL,       "Generate output as comma separated variables." },
     { 'a', "delimiter", "char",     "Character used to separate csv fields." },
@@ -126,7 +137,16 @@ int Configuration::parseCommandLine(int argc, char *argv[])
         case 'd': setDuration(option.getArg()); break;
         case 'e': enableEven(); break;
         case 'b': setBoxes(option.getArg()); break;
+        case 'r': setRange(option.getArg()); break;
         case 's': enableShuffle(); break;
+        case 'j': setJobs(option.getArg()); break;
+        case 'n': setEngine(option.getArg()); break;
+        case 'm': setMemory(option.getArg()); break;
+        case 'q': setTarget(option.getArg()); break;
+        case 'g': setGap(option.getArg()); break;
+        case 'l': enableStream(); break;
+        case 'k': setCheckpoint(option.getArg()); break;
+        case 'u': enableResume(); break;
         case 'p': enablePlain(); break;
         case 'c': enableCSV(); break;
         case 'a': setDivider(option.getArg()); break;
@@ -141,6 +161,35 @@ int Configuration::parseCommandLine(int argc, char *argv[])
 }
 
 
+/**
+ * @brief Get the number of threads to use, which is the number of jobs asked
+ * for but no more than the machine can run at once, as more only add
+ * contention.
+ * 
+ * @return size_t the number of threads.
+ */
+size_t Configuration::getThreads(void)
+{
+    const size_t cores{std::max(std::thread::hardware_concurrency(), 1U)};
+
+    return std::min(getJobs(), cores);
+}
+
+
+/**
+ * @brief Set the range of the number of sides from text of the form MIN..MAX,
+ * or a single number.
+ * 
+ * @param range text holding the fewest and the most sides.
+ */
+void Configuration::setRange(std::string range)
+{
+    const auto dots{range.find("..")};
+    minimum = std::stoi(range);
+    maximum = (dots == std::string::npos) ? minimum : std::stoi(range.substr(dots + 2));
+}
+
+
 /**
  * @brief Initialise 'TrackSort' using command line input and ensure we only
  * do it once.
@@ -173,13 +222,26 @@ void Configuration::display(std::ostream &os) const
 {
     os << "Config is " << std::string{isValid() ? "" : "NOT "} << "valid\n";
     os << "Input file name:  " << getInputFile() << '\n';
-    os << "Timeout: " << getTimeout() << "s\n";
+    os << "Timeout: " << getTimeout() << "ms\n";
     os << "Disc duration: " << getDuration() << "s\n";
     if (isEven())
         os << "An even number of sides requested.\n";
     os << "Boxes: " << getBoxes() << "\n";
+    if (isRange())
+        os << "Range: " << getMinimum() << ".." << getMaximum() << "\n";
     if (isShuffle())
         os << "Optimal reordering of tracks requested.\n";
+    os << "Jobs: " << getJobs() << "\n";
+    os << "Engine: " << getEngine() << "\n";
+    os << "Memory: " << getMemory() << "MB\n";
+    os << "Target: " << getTarget() << "s\n";
+    os << "Gap: " << getGap() << "s\n";
+    if (isStream())
+        os << "Streaming each better shuffle as JSON Lines.\n";
+    if (!getCheckpoint().empty())
+        os << "Checkpoint file name:  " << getCheckpoint() << '\n';
+    if (isResume())
+        os << "Resuming from the checkpoint file.\n";
     if (isPlain())
         os << "Display lengths in seconds instead of hh:mm:ss.\n";
     if (isCSV())
@@ -198,6 +260,9 @@ bool Configuration::isValid(bool showErrors)
 {
     namespace fs = std::filesystem;
 
+    const size_t maximumMemory{1 << 20};    // Megabytes, so a terabyte.
+    const size_t maximumJobs{1024};         // Catches negative counts.
+
     const auto & inputFile{getInputFile()};
 
     if (inputFile.string().empty())
@@ -218,7 +283,33 @@ bool Configuration::isValid(bool showErrors)
 
     auto duration{getDuration()};
     auto boxes{getBoxes()};
-    if (((duration == 0) && (boxes == 0)) || ((duration != 0) && (boxes != 0)))
+    if (isRange())
+    {
+        if (boxes != 0)
+        {
+            if (showErrors)
+                std::cerr << "\nEither a range of sides or sides (boxes) may be specified, but not both\n";
+
+            return false;
+        }
+
+        if ((getMinimum() == 0) || (getMinimum() > getMaximum()))
+        {
+            if (showErrors)
+                std::cerr << "\nRange must be given as MIN..MAX, where MIN is at least 1 and no more than MAX.\n";
+
+            return false;
+        }
+
+        if (isShuffle())
+        {
+            if (showErrors)
+                std::cerr << "\nA range of sides can only be split when keeping the track order.\n";
+
+            return false;
+        }
+    }
+    else if (((duration == 0) && (boxes == 0)) || ((duration != 0) && (boxes != 0)))
     {
         if (showErrors)
             std::cerr << "\nEither duration or sides (boxes) must be specified, but not both\n";
@@ -226,6 +317,43 @@ bool Configuration::isValid(bool showErrors)
         return false;
     }
 
+    if ((getJobs() == 0) || (getJobs() > maximumJobs))
+    {
+        if (showErrors)
+            std::cerr << "\nNumber of jobs must be from 1 to " << maximumJobs << ".\n";
+
+        return false;
+    }
+
+    if ((showErrors) && (isDebug()) && (getThreads() < getJobs()))
+        std::cerr << "\nUsing " << getThreads() << " threads, the most this machine runs at once.\n";
+
+    if (getMemory() > maximumMemory)
+    {
+        if (showErrors)
+            std::cerr << "\nMemory must be from 0 to " << maximumMemory << " megabytes.\n";
+
+        return false;
+    }
+
+    const auto & engine{getEngine()};
+    if ((engine != "finder") && (engine != "ckk"))
+    {
+        if (showErrors)
+            std::cerr << "\nEngine must be either finder or ckk, not " << engine << ".\n";
+
+        return false;
+    }
+
+    const auto & checkpoint{getCheckpoint()};
+    if ((isResume()) && ((checkpoint.string().empty()) || (!fs::exists(checkpoint))))
+    {
+        if (showErrors)
+            std::cerr << "\nResuming requires an existing checkpoint file.\n";
+
+        return false;
+    }
+
     if ((boxes != 0) && (isEven()))
     {
         if (showErrors)
@@ -43,8 +43,8 @@ class Configuration
 private:
 //- Hide the default constructor and destructor.
     Configuration(void) : 
-        name{"TrackSort"}, inputFile{}, timeout{60}, seconds{}, even{},
-        boxes{}, shuffle{}, plain{}, csv{}, delimiter{','}, debug{}
+        name{"TrackSort"}, inputFile{}, timeout{60000}, seconds{}, even{},
+        boxes{}, minimum{}, maximum{}, shuffle{}, jobs{1}, engine{"finder"}, memory{16}, target{}, gap{}, stream{}, checkpoint{}, resume{}, plain{}, csv{}, delimiter{','}, debug{}
         {  }
     virtual ~Configuration(void) {}
 
@@ -56,7 +56,17 @@ private:
     size_t seconds;
     bool even;
     size_t boxes;
+    size_t minimum;
+    size_t maximum;
     bool shuffle;
+    size_t jobs;
+    std::string engine;
+    size_t memory;
+    double target;
+    double gap;
+    bool stream;
+    std::filesystem::path checkpoint;
+    bool resume;
     bool plain;
     bool csv;
     char delimiter;
@@ -64,11 +74,20 @@ private:
 
     void setName(std::string value) { name = value; }
     void setInputFile(std::string name) { inputFile = name; }
-    void setTimeout(std::string time) { timeout = timeStringToSeconds(time); }
+    void setTimeout(std::string time) { timeout = timeStringToMilliseconds(time); }
     void setDuration(std::string time) { seconds = timeStringToSeconds(time); }
     void enableEven() { even = true; }
     void setBoxes(std::string count) { boxes = std::stoi(count); }
+    void setRange(std::string range);
     void enableShuffle() { shuffle = true; }
+    void setJobs(std::string count) { jobs = std::stoi(count); }
+    void setEngine(std::string name) { engine = name; }
+    void setMemory(std::string size) { memory = std::stoi(size); }
+    void setTarget(std::string time) { target = timeStringToMilliseconds(time) / 1000.0; }
+    void setGap(std::string time) { gap = timeStringToMilliseconds(time) / 1000.0; }
+    void enableStream() { stream = true; }
+    void setCheckpoint(std::string name) { checkpoint = name; }
+    void enableResume() { resume = true; }
     void enablePlain() { plain = true; }
     void enableCSV() { csv = true; }
     void setDivider(std::string div) { delimiter = div[0]; }
@@ -94,7 +113,19 @@ public:
     static size_t getDuration(void) { return instance().seconds; }
     static bool isEven(void) { return instance().even; }
     static size_t getBoxes(void) { return instance().boxes; }
+    static bool isRange(void) { return instance().maximum != 0; }
+    static size_t getMinimum(void) { return instance().minimum; }
+    static size_t getMaximum(void) { return instance().maximum; }
     static bool isShuffle(void) { return instance().shuffle; }
+    static size_t getJobs(void) { return instance().jobs; }
+    static size_t getThreads(void);
+    static std::string & getEngine(void) { return instance().engine; }
+    static size_t getMemory(void) { return instance().memory; }
+    static double getTarget(void) { return instance().target; }
+    static double getGap(void) { return instance().gap; }
+    static bool isStream(void) { return instance().stream; }
+    static std::filesystem::path & getCheckpoint(void) { return instance().checkpoint; }
+    static bool isResume(void) { return instance().resume; }
     static bool isPlain(void) { return instance().plain; }
     static bool isCSV(void) { return instance().csv; }
     static char getDelimiter(void) { return instance().delimiter; }
@@ -0,0 +1,127 @@
+/**
+ * @file    LoadBench.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'TrackSort' is a command-line utility for splitting tracks across multiple
+ * sides.
+ *
+ * Microbenchmark for the load kernels, built and run with:
+ *    make bench
+ *
+ * For each number of sides it times the standard deviation of the side
+ * lengths found with std::pow per side, the scalar kernel and the kernel
+ * chosen for this processor, and reports the time per call.
+ */
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <numeric>
+#include <iomanip>
+#include <iostream>
+
+#include "Side.h"
+#include "Utilities.h"
+
+
+// Keeps each result so the calls being timed are not optimised away.
+volatile double sink{};
+
+
+/**
+ * @brief Calculate the standard deviation the way it was found before the
+ * load kernels, for comparison.
+ *
+ * @param loads list of side lengths.
+ * @return double the calculated the standard deviation.
+ */
+static double deviationWithPow(const std::vector<size_t> & loads)
+{
+    const double count{(double)loads.size()};
+    auto sum = [](double a, size_t b) { return a + b; };
+    const double mean{std::accumulate(loads.begin(), loads.end(), 0.0, sum) / count};
+    auto square = [mean](double a, size_t b) { return a + std::pow(b - mean, 2); };
+
+    return std::sqrt(std::accumulate(loads.begin(), loads.end(), 0.0, square) / count);
+}
+
+/**
+ * @brief Calculate the standard deviation with the scalar kernel.
+ *
+ * @param loads list of side lengths.
+ * @return double the calculated the standard deviation.
+ */
+static double deviationWithScalar(const std::vector<size_t> & loads)
+{
+    const size_t count{loads.size()};
+    size_t sum{};
+    size_t squares{};
+    sumLoadsScalar(loads.data(), count, sum, squares);
+
+    return std::sqrt((double)(count * squares - sum * sum)) / count;
+}
+
+/**
+ * @brief Time the given way of finding the standard deviation.
+ *
+ * @param method used to find the standard deviation.
+ * @param loads list of side lengths.
+ * @param repeats number of calls to time.
+ * @return double the time per call in nanoseconds.
+ */
+template<typename F>
+static double measure(F method, const std::vector<size_t> & loads, size_t repeats)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const auto start{Clock::now()};
+    for (size_t i = 0; i < repeats; ++i)
+        sink = method(loads);
+    const std::chrono::duration<double, std::nano> elapsed{Clock::now() - start};
+
+    return elapsed.count() / repeats;
+}
+
+int main(void)
+{
+    std::mt19937_64 random{};
+    std::uniform_int_distribution<size_t> length{10 * 60, 60 * 60};
+
+    std::cout << "Load kernel " << getLoadKernel() << "\n";
+    std::cout << std::setw(8) << "sides" << std::setw(12) << "pow ns" << std::setw(12) << "scalar ns" << std::setw(12) << "kernel ns" << "\n";
+
+    for (size_t count : {8, 100, 1000, 10000})
+    {
+        std::vector<size_t> loads(count);
+        for (auto & load : loads)
+            load = length(random);
+
+        // About 50 million side lengths per measurement.
+        const size_t repeats{50000000 / count};
+        const double pow{measure(deviationWithPow, loads, repeats)};
+        const double scalar{measure(deviationWithScalar, loads, repeats)};
+        const double kernel{measure([](const std::vector<size_t> & list) { return deviation(list); }, loads, repeats)};
+
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << std::setw(8) << count << std::setw(12) << pow << std::setw(12) << scalar << std::setw(12) << kernel << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,607 @@
+/**
+ * @file    Packing.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'TrackSort' is a command-line utility for splitting tracks across multiple
+ * sides.
+ *
+ * Bin packing code for the track shuffler.
+ */
+
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+
+#include "Side.h"
+#include "Utilities.h"
+#include "Partition.h"
+#include "Packing.h"
+
+
+/**
+ * @section bin packing code.
+ *
+ * The lower bounds are those of Martello and Toth. L1 divides the total
+ * length by the side length. L2 also counts the tracks too long to share a
+ * side with each other. L3 first fixes sides that some optimal packing is
+ * sure to use, then applies L2 to the tracks left over.
+ */
+
+/**
+ * @brief Get the track lengths, longest first.
+ * 
+ * @param tracks sorted longest first.
+ * @return std::vector<size_t> the track lengths.
+ */
+static std::vector<size_t> getLengths(const std::vector<Track> & tracks)
+{
+    std::vector<size_t> lengths{};
+    lengths.reserve(tracks.size());
+    for (const auto & track : tracks)
+        lengths.push_back(track.getValue());
+
+    return lengths;
+}
+
+/**
+ * @brief Get the total length of the longest tracks before each index.
+ * 
+ * @param lengths sorted longest first.
+ * @param prefix updated with the running totals.
+ */
+static void getPrefix(std::span<const size_t> lengths, std::vector<size_t> & prefix)
+{
+    prefix.resize(lengths.size() + 1);
+    for (size_t i = 0; i < lengths.size(); ++i)
+        prefix[i+1] = prefix[i] + lengths[i];
+}
+
+/**
+ * @brief Calculate the L2 bound for a list of lengths. For each threshold
+ * 'limit', the tracks longer than half a side each need a side of their own,
+ * and the tracks from 'limit' to half a side can only use the space those
+ * sides leave if nothing longer than the side less 'limit' is on them. As the
+ * threshold falls, fewer tracks are longer than the side less 'limit', so
+ * they are counted by walking back from the previous count.
+ * 
+ * @param lengths sorted longest first.
+ * @param prefix total length of the longest tracks before each index.
+ * @param duration length of a side.
+ * @return size_t the lower bound.
+ */
+static size_t boundL2(std::span<const size_t> lengths, const std::vector<size_t> & prefix, size_t duration)
+{
+    const size_t count{lengths.size()};
+    const size_t total{prefix[count]};
+    const size_t half{(size_t)(std::lower_bound(lengths.begin(), lengths.end(), duration / 2, std::greater<size_t>{}) - lengths.begin())};
+    size_t best{std::max(half, (total + duration - 1) / duration)};
+
+    size_t large{half};
+    for (size_t i = half; i < count; ++i)
+    {
+        // Try each distinct length up to half a side as the threshold.
+        const size_t limit{lengths[i]};
+        if ((i + 1 < count) && (lengths[i+1] == limit))
+            continue;
+
+        while ((large) && (lengths[large-1] <= duration - limit))
+            --large;
+
+        const size_t medium{half - large};
+        const size_t used{prefix[half] - prefix[large]};
+        const size_t small{prefix[i+1] - prefix[half]};
+
+        const size_t space{medium * duration - used};
+        const size_t extra{small > space ? (small - space + duration - 1) / duration : 0};
+
+        best = std::max(best, large + medium + extra);
+    }
+
+    return best;
+}
+
+/**
+ * @brief Fix the sides that some optimal packing is sure to use. If no two
+ * other tracks fit on a side with a track, the side it is on holds at most
+ * one other track, and swapping that for the longest track that fits never
+ * makes a packing worse. If two tracks fit with the longest track, they also
+ * fit with every shorter one, so only the longest tracks need checking.
+ * 
+ * @param items lengths of the tracks not yet on a fixed side, longest first.
+ * @param duration length of a side.
+ * @return size_t the number of sides fixed.
+ */
+static size_t reduce(std::vector<size_t> & items, size_t duration)
+{
+    size_t fixed{};
+    while (!items.empty())
+    {
+        const size_t count{items.size()};
+        const size_t space{duration - items.front()};
+
+        // Stop if two others fit with the longest track.
+        if ((count >= 3) && (items[count-1] + items[count-2] <= space))
+            break;
+
+        items.erase(items.begin());
+
+        const auto fit{std::lower_bound(items.begin(), items.end(), space, std::greater<size_t>{})};
+        if (fit != items.end())
+            items.erase(fit);
+
+        ++fixed;
+    }
+
+    return fixed;
+}
+
+/**
+ * @brief Calculate the L1 bound, the total length divided by the side length.
+ * 
+ * @param tracks sorted longest first.
+ * @param duration length of a side.
+ * @return size_t the lower bound.
+ */
+size_t lowerBoundL1(const std::vector<Track> & tracks, size_t duration)
+{
+    size_t total{};
+    for (const auto & track : tracks)
+        total += track.getValue();
+
+    return (total + duration - 1) / duration;
+}
+
+/**
+ * @brief Calculate the L2 bound of Martello and Toth.
+ * 
+ * @param tracks sorted longest first.
+ * @param duration length of a side.
+ * @return size_t the lower bound.
+ */
+size_t lowerBoundL2(const std::vector<Track> & tracks, size_t duration)
+{
+    const auto lengths{getLengths(tracks)};
+    std::vector<size_t> prefix{};
+    getPrefix(lengths, prefix);
+
+    return boundL2(lengths, prefix, duration);
+}
+
+/**
+ * @brief Calculate the L3 bound of Martello and Toth. Sides are fixed by
+ * reduction and L2 is applied to the tracks left over. Removing the shortest
+ * track can only lower the bound, but may allow more sides to be fixed, so
+ * this is repeated until no tracks are left and the best bound is kept.
+ * 
+ * Removing the shortest track leaves the running totals of the others as
+ * they are and never raises L2, so the totals are only rebuilt and L2 only
+ * recalculated once more sides are fixed. Each side fixed removes at least
+ * one track, so once the sides fixed and the tracks left are no more than
+ * the best bound, nothing better can be found.
+ * 
+ * @param tracks sorted longest first.
+ * @param duration length of a side.
+ * @param timer stops the search for a better bound when expired.
+ * @return size_t the lower bound.
+ */
+size_t lowerBoundL3(const std::vector<Track> & tracks, size_t duration, const Timer & timer)
+{
+    auto items{getLengths(tracks)};
+    std::vector<size_t> prefix{};
+    getPrefix(items, prefix);
+
+    size_t best{boundL2(items, prefix, duration)};
+    size_t fixed{};
+    while ((fixed + items.size() > best) && (timer.isWorking()))
+    {
+        const size_t sides{reduce(items, duration)};
+        if (sides)
+        {
+            fixed += sides;
+            getPrefix(items, prefix);
+            best = std::max(best, fixed + boundL2(items, prefix, duration));
+        }
+
+        if (!items.empty())
+        {
+            items.pop_back();
+            prefix.pop_back();
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Pack the tracks using first fit decreasing, placing each track on
+ * the first side with room for it. This gives a number of sides that is
+ * always enough.
+ * 
+ * @param tracks sorted longest first.
+ * @param duration length of a side.
+ * @param assignment side of each track.
+ * @return size_t the number of sides used.
+ */
+size_t firstFitDecreasing(const std::vector<Track> & tracks, size_t duration, Assignment & assignment)
+{
+    std::vector<size_t> loads{};
+    assignment.resize(tracks.size());
+    for (size_t track = 0; track < tracks.size(); ++track)
+    {
+        const size_t seconds{tracks[track].getValue()};
+
+        size_t side{};
+        while ((side < loads.size()) && (loads[side] + seconds > duration))
+            ++side;
+
+        if (side == loads.size())
+            loads.push_back(0);
+
+        loads[side] += seconds;
+        assignment[track] = side;
+    }
+
+    return loads.size();
+}
+
+
+
+/**
+ * @section Define Completer class.
+ *
+ * Completer implements the bin completion algorithm of Korf, which decides if
+ * the tracks fit on a given number of sides. Sides are filled one at a time,
+ * each starting with the longest track left. Only the ways of completing a
+ * side that are not dominated by another way are tried, as anything packed
+ * alongside a dominated completion can be packed alongside the one that
+ * dominates it. A completion is dominated if another track still fits on the
+ * side, or if a track on the side can be swapped for a longer one left out.
+ */
+
+class Completer
+{
+public:
+    Completer(const std::vector<Track> & tracks, size_t duration, const Timer & timer);
+
+    bool search(size_t & lower, size_t & upper, Assignment & assignment);
+
+private:
+    struct Choice
+    {
+        size_t index;
+        bool included;
+    };
+
+    bool pack(size_t sides, size_t start);
+    bool complete(size_t sides, size_t start);
+    bool isDominated(const std::vector<Choice> & choices, std::span<const size_t> items, size_t space) const;
+    void sum(size_t start);
+    void restore(size_t start);
+    void assign(Assignment & assignment) const;
+
+    const std::vector<size_t> lengths;
+    const size_t duration;
+    const Timer & timer;
+    size_t total;
+
+    size_t limit;
+    size_t waste;
+    size_t allowed;
+    std::vector<std::vector<size_t>> contents;
+    std::vector<size_t> prefix;
+
+    // The lengths of the tracks left for each side are the end of 'pool' from
+    // where the sides before it finish, longest first, with the total length
+    // from each index onwards in 'suffix'.
+    std::vector<size_t> pool;
+    std::vector<size_t> suffix;
+};
+
+Completer::Completer(const std::vector<Track> & tracks, size_t dur, const Timer & tim) :
+    lengths{getLengths(tracks)}, duration{dur}, timer{tim}, total{},
+    limit{}, waste{}, allowed{}, contents{}, prefix{}, pool{}, suffix{}
+{
+    for (const auto & seconds : lengths)
+        total += seconds;
+}
+
+/**
+ * @brief Determine if a completion of a side is dominated by another. The
+ * choices are the tracks put on the side or left out while they still fit,
+ * longest first. If any track left out still fits, adding it dominates. If a
+ * track left out fits in place of a shorter one put on the side after it, the
+ * swap dominates, and the longest shorter track is the easiest to swap for.
+ * 
+ * @param choices made in filling the side.
+ * @param items lengths of the tracks to choose from, longest first.
+ * @param space left on the side.
+ * @return true if the completion is dominated.
+ * @return false otherwise.
+ */
+bool Completer::isDominated(const std::vector<Choice> & choices, std::span<const size_t> items, size_t space) const
+{
+    auto included = [](const Choice & choice) { return choice.included; };
+
+    for (auto choice{choices.begin()}; choice != choices.end(); ++choice)
+    {
+        if (choice->included)
+            continue;
+
+        const size_t left{items[choice->index]};
+        if (left <= space)
+            return true;
+
+        const auto swap{std::find_if(choice, choices.end(), included)};
+        if ((swap != choices.end()) && (left <= items[swap->index] + space))
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Total the lengths of the tracks left from each index onwards.
+ * 
+ * @param start index in the pool of the first track left.
+ */
+void Completer::sum(size_t start)
+{
+    for (size_t i = pool.size(); i-- > start; )
+        suffix[i] = suffix[i+1] + pool[i];
+}
+
+/**
+ * @brief Merge the tracks of the last side filled, which are at the start of
+ * the tracks left, back in among the rest, longest first.
+ * 
+ * @param start index in the pool of the first track left.
+ */
+void Completer::restore(size_t start)
+{
+    const auto & side{contents.back()};
+    size_t read{start + side.size()};
+    size_t write{start};
+    for (const auto & seconds : side)
+    {
+        while ((read < pool.size()) && (pool[read] > seconds))
+            pool[write++] = pool[read++];
+
+        pool[write++] = seconds;
+    }
+}
+
+/**
+ * @brief Try each undominated completion of the next side, starting with the
+ * longest track left, and pack the remaining sides after each. Completions
+ * are generated by putting every track that fits on the side, longest first,
+ * then repeatedly leaving out the last track put on. Leaving out one of
+ * several tracks of the same length leaves out the shorter copies as well, so
+ * no completion is generated twice.
+ * 
+ * The tracks put on the side are moved to the start of the tracks left, so
+ * the rest are left in order for the next side without copying them, and
+ * are merged back after it.
+ * 
+ * @param sides number of sides already filled.
+ * @param start index in the pool of the first track left.
+ * @return true if all the tracks were packed.
+ * @return false otherwise.
+ */
+bool Completer::complete(size_t sides, size_t start)
+{
+    const std::span<const size_t> items{pool.data() + start, pool.size() - start};
+    const size_t * const after{suffix.data() + start};
+    sum(start);
+
+    auto firstFit = [&items](size_t from, size_t space)
+    {
+        return (size_t)(std::lower_bound(items.begin() + from, items.end(), space, std::greater<size_t>{}) - items.begin());
+    };
+    auto nextShorter = [&items](size_t index)
+    {
+        return (size_t)(std::upper_bound(items.begin() + index, items.end(), items[index], std::greater<size_t>{}) - items.begin());
+    };
+
+    // The longest track left always starts the side, and the space left on
+    // it must not take the total wasted over what the sides allow.
+    const size_t slack{allowed - waste};
+    std::vector<Choice> choices{};
+    size_t space{duration - items[0]};
+    size_t from{1};
+
+    // Leave out the last track put on, as long as the shorter tracks could
+    // still fill the space so that it no longer fits and within the slack.
+    auto leaveOut = [&]()
+    {
+        while (!choices.empty())
+        {
+            const Choice choice{choices.back()};
+            choices.pop_back();
+            if (!choice.included)
+                continue;
+
+            const size_t seconds{items[choice.index]};
+            space += seconds;
+            from = nextShorter(choice.index);
+            if ((space >= after[from] + seconds) || (space > after[from] + slack))
+                continue;
+
+            choices.push_back({choice.index, false});
+
+            return true;
+        }
+
+        return false;
+    };
+
+    do
+    {
+        // Put every track that fits on the side, longest first.
+        for (size_t index = firstFit(from, space); index < items.size(); index = firstFit(index + 1, space))
+        {
+            choices.push_back({index, true});
+            space -= items[index];
+        }
+
+        if ((space > slack) || (isDominated(choices, items, space)))
+            continue;
+
+        std::vector<size_t> side{items[0]};
+        for (const auto & choice : choices)
+            if (choice.included)
+                side.push_back(items[choice.index]);
+
+        // Move the rest to the end, from the shortest back, then put the
+        // side in front of them.
+        auto choice{choices.rbegin()};
+        size_t next{pool.size()};
+        for (size_t index = items.size(); index-- > 1; )
+        {
+            while ((choice != choices.rend()) && (choice->index > index))
+                ++choice;
+
+            if ((choice == choices.rend()) || (choice->index != index) || (!choice->included))
+                pool[--next] = pool[start + index];
+        }
+        std::copy(side.begin(), side.end(), pool.begin() + start);
+
+        contents.push_back(std::move(side));
+        waste += space;
+        if (pack(sides + 1, next))
+            return true;
+
+        waste -= space;
+        restore(start);
+        contents.pop_back();
+        sum(start);
+    } while ((timer.isWorking()) && (leaveOut()));
+
+    return false;
+}
+
+/**
+ * @brief Pack the tracks left onto the sides left, unless a bound shows they
+ * cannot fit.
+ * 
+ * @param sides number of sides already filled.
+ * @param start index in the pool of the first track left.
+ * @return true if all the tracks were packed.
+ * @return false otherwise.
+ */
+bool Completer::pack(size_t sides, size_t start)
+{
+    if (start == pool.size())
+        return true;
+
+    if ((sides == limit) || (!timer.isWorking()))
+        return false;
+
+    const std::span<const size_t> items{pool.data() + start, pool.size() - start};
+    getPrefix(items, prefix);
+    if (sides + boundL2(items, prefix, duration) > limit)
+        return false;
+
+    return complete(sides, start);
+}
+
+/**
+ * @brief Turn the lengths packed on each side into the side of each track.
+ * Tracks of the same length are interchangeable, so they are handed out in
+ * order.
+ * 
+ * @param assignment side of each track.
+ */
+void Completer::assign(Assignment & assignment) const
+{
+    std::vector<size_t> taken(lengths.size());
+    assignment.assign(lengths.size(), 0);
+    for (size_t side = 0; side < contents.size(); ++side)
+    {
+        for (const auto & seconds : contents[side])
+        {
+            const size_t first = std::lower_bound(lengths.begin(), lengths.end(), seconds, std::greater<size_t>{}) - lengths.begin();
+            assignment[first + taken[first]++] = side;
+        }
+    }
+}
+
+/**
+ * @brief Find the fewest sides the tracks fit on, trying each number of
+ * sides from the lower bound up.
+ * 
+ * @param lower bound on the number of sides, raised as each number of sides
+ * is shown to be too few.
+ * @param upper number of sides known to be enough, lowered if the tracks are
+ * packed onto fewer.
+ * @param assignment updated with the side of each track if fewer sides are
+ * found to be enough.
+ * @return true if the fewest sides were found.
+ * @return false if the timer expired first.
+ */
+bool Completer::search(size_t & lower, size_t & upper, Assignment & assignment)
+{
+    for (limit = lower; limit < upper; ++limit)
+    {
+        allowed = limit * duration - total;
+        waste = 0;
+        contents.clear();
+        pool = lengths;
+        suffix.assign(lengths.size() + 1, 0);
+
+        if (pack(0, 0))
+        {
+            upper = limit;
+            assign(assignment);
+
+            return true;
+        }
+
+        if (!timer.isWorking())
+            return false;
+
+        lower = limit + 1;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Find the fewest sides of length 'duration' the tracks fit on, using
+ * bin completion, between the bounds already known.
+ * 
+ * @param tracks sorted longest first.
+ * @param duration length of a side.
+ * @param timer limiting the time spent searching.
+ * @param lower bound on the number of sides, raised as the search goes on.
+ * @param upper number of sides known to be enough, lowered as the search goes
+ * on.
+ * @param assignment updated with the side of each track if fewer than 'upper'
+ * sides are enough.
+ * @return true if the fewest sides were found.
+ * @return false if the timer expired first.
+ */
+bool completeBins(const std::vector<Track> & tracks, size_t duration, const Timer & timer,
+    size_t & lower, size_t & upper, Assignment & assignment)
+{
+    Completer completer{tracks, duration, timer};
+
+    return completer.search(lower, upper, assignment);
+}
@@ -0,0 +1,52 @@
+/**
+ * @file    Packing.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'TrackSort' is a command-line utility for splitting tracks across multiple
+ * sides.
+ *
+ * Bin packing interfaces for the track shuffler.
+ */
+
+#if !defined _PACKING_H_INCLUDED_
+#define _PACKING_H_INCLUDED_
+
+#include <vector>
+
+#include "Side.h"
+#include "Utilities.h"
+#include "Partition.h"
+
+/**
+ * @section bin packing code.
+ *
+ * Bounds on the fewest sides of length 'duration' that can hold all the
+ * tracks. The tracks must be sorted longest first and none may be longer
+ * than 'duration'. Bin completion searches between the bounds for the fewest
+ * sides that are enough.
+ */
+
+extern size_t lowerBoundL1(const std::vector<Track> & tracks, size_t duration);
+extern size_t lowerBoundL2(const std::vector<Track> & tracks, size_t duration);
+extern size_t lowerBoundL3(const std::vector<Track> & tracks, size_t duration, const Timer & timer);
+extern size_t firstFitDecreasing(const std::vector<Track> & tracks, size_t duration, Assignment & assignment);
+extern bool completeBins(const std::vector<Track> & tracks, size_t duration, const Timer & timer,
+    size_t & lower, size_t & upper, Assignment & assignment);
+
+#endif //!defined _PACKING_H_INCLUDED_
@@ -0,0 +1,1082 @@
+/**
+ * @file    Partition.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'TrackSort' is a command-line utility for splitting tracks across multiple
+ * sides.
+ *
+ * Number partitioning code for the track shuffler.
+ */
+
+#include <vector>
+#include <queue>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <cmath>
+
+#include "Side.h"
+#include "Utilities.h"
+#include "Partition.h"
+
+
+/**
+ * @section Define Partial class.
+ *
+ * A Partial is a partition of some of the tracks across all the sides, with
+ * the subsets kept in order of length, longest first. Only the subsets
+ * holding tracks are kept, the rest of the sides being empty, so a Partial
+ * of a single track is a single subset however many sides there are. The
+ * tracks of each subset are a list linked through 'next', which is shared by
+ * all the Partials, so subsets are joined without copying their tracks.
+ */
+
+class Partial
+{
+public:
+    Partial(size_t track, size_t seconds);
+
+    void combine(Partial & other, size_t sideCount, std::vector<size_t> & next);
+
+    size_t getSpread(size_t sideCount) const;
+    void assign(Assignment & assignment, const std::vector<size_t> & next) const;
+
+private:
+    struct Subset
+    {
+        size_t seconds;
+        size_t first;
+        size_t last;
+    };
+
+    std::vector<Subset> subsets;
+};
+
+/**
+ * @brief Construct a new Partial with the given track on one side and all the
+ * other sides empty.
+ * 
+ * @param track index of the track.
+ * @param seconds length of the track.
+ */
+Partial::Partial(size_t track, size_t seconds) : subsets{Subset{seconds, track, track}}
+{
+}
+
+/**
+ * @brief Get the difference in length between the longest and shortest
+ * sides, which is the longest side if any side is empty.
+ * 
+ * @param sideCount number of sides.
+ * @return size_t the spread of the side lengths.
+ */
+size_t Partial::getSpread(size_t sideCount) const
+{
+    if (subsets.empty())
+        return 0;
+
+    const size_t shortest{subsets.size() < sideCount ? 0 : subsets.back().seconds};
+
+    return subsets.front().seconds - shortest;
+}
+
+/**
+ * @brief Merge the other Partial into this one by pairing the longest subsets
+ * of one with the shortest subsets of the other, the empty sides being the
+ * shortest. Only the subsets holding tracks are visited.
+ * 
+ * @param other Partial to merge, which is left empty.
+ * @param sideCount number of sides.
+ * @param next link from each track to the next track of its subset.
+ */
+void Partial::combine(Partial & other, size_t sideCount, std::vector<size_t> & next)
+{
+    // Subset i of this Partial pairs with subset sideCount - 1 - i of the
+    // other, so the other's subsets beyond this one's pair with empty sides.
+    const size_t count{subsets.size()};
+    const size_t pairs{other.subsets.size()};
+    for (size_t j = 0; j < pairs; ++j)
+    {
+        const auto & pair{other.subsets[j]};
+        const size_t i{sideCount - 1 - j};
+        if (i < count)
+        {
+            auto & subset{subsets[i]};
+            subset.seconds += pair.seconds;
+            next[subset.last] = pair.first;
+            subset.last = pair.last;
+        }
+        else
+        {
+            subsets.push_back(pair);
+        }
+    }
+    other.subsets.clear();
+    other.subsets.shrink_to_fit();
+
+    // Only the shortest subsets have changed, so only they need sorting
+    // before merging with the rest, which are still in order.
+    const auto changed{subsets.begin() + std::min(count, sideCount - pairs)};
+    auto comp = [](const Subset & a, const Subset & b) { return a.seconds > b.seconds; };
+    std::sort(changed, subsets.end(), comp);
+    std::inplace_merge(subsets.begin(), changed, subsets.end(), comp);
+}
+
+void Partial::assign(Assignment & assignment, const std::vector<size_t> & next) const
+{
+    for (size_t side = 0; side < subsets.size(); ++side)
+    {
+        const auto & subset{subsets[side]};
+        for (size_t track = subset.first; ; track = next[track])
+        {
+            assignment[track] = side;
+            if (track == subset.last)
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Partition the tracks across the sides using the largest differencing
+ * method of Karmarkar and Karp. Each track starts as a Partial of its own, then
+ * the two Partials with the largest spread are repeatedly combined until only
+ * one remains.
+ * 
+ * @param tracks to partition.
+ * @param sideCount number of sides.
+ * @return Assignment the side of each track.
+ */
+Assignment karmarkarKarp(const std::vector<Track> & tracks, size_t sideCount)
+{
+    std::vector<Partial> partials{};
+    partials.reserve(tracks.size());
+    for (size_t i = 0; i < tracks.size(); ++i)
+        partials.emplace_back(i, tracks[i].getValue());
+
+    std::vector<size_t> next(tracks.size());
+
+    // Spreads only change when combining, so they are kept for the queue.
+    std::vector<size_t> spreads(tracks.size());
+    for (size_t i = 0; i < partials.size(); ++i)
+        spreads[i] = partials[i].getSpread(sideCount);
+
+    auto comp = [&spreads](size_t a, size_t b) { return spreads[a] < spreads[b]; };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(comp)> queue{comp};
+    for (size_t i = 0; i < partials.size(); ++i)
+        queue.push(i);
+
+    Assignment assignment(tracks.size());
+    if (queue.empty())
+        return assignment;
+
+    while (queue.size() > 1)
+    {
+        const size_t first{queue.top()};
+        queue.pop();
+        const size_t second{queue.top()};
+        queue.pop();
+
+        partials[first].combine(partials[second], sideCount, next);
+        spreads[first] = partials[first].getSpread(sideCount);
+        queue.push(first);
+    }
+
+    partials[queue.top()].assign(assignment, next);
+
+    return assignment;
+}
+
+
+/**
+ * @section Define Bits class.
+ *
+ * Bits is a minimal dynamic bitset supporting the word parallel shift and OR
+ * needed to build the sums reachable by subsets of the tracks.
+ */
+
+class Bits
+{
+public:
+    Bits(size_t count) : size{count + 1}, words((size + 63) / 64) {}
+
+    void set(size_t i) { words[i / 64] |= (uint64_t)1 << (i % 64); }
+    bool test(size_t i) const { return (words[i / 64] >> (i % 64)) & 1; }
+    void include(const Bits & other, size_t shift);
+
+private:
+    size_t size;
+    std::vector<uint64_t> words;
+};
+
+/**
+ * @brief OR the other Bits, shifted up by the given amount, into these Bits.
+ * Bits shifted beyond the size are discarded.
+ * 
+ * @param other Bits to include.
+ * @param shift number of bits to shift by.
+ */
+void Bits::include(const Bits & other, size_t shift)
+{
+    const size_t count{words.size()};
+    const size_t step{shift / 64};
+    const size_t bit{shift % 64};
+
+    for (size_t i = count; i-- > step; )
+    {
+        uint64_t word{other.words[i - step] << bit};
+        if ((bit) && (i > step))
+            word |= other.words[i - step - 1] >> (64 - bit);
+
+        words[i] |= word;
+    }
+
+    // Clear any bits beyond the size.
+    if (size % 64)
+        words.back() &= ((uint64_t)1 << (size % 64)) - 1;
+}
+
+/**
+ * @brief Balance the tracks across two sides exactly by finding the subset
+ * whose length is closest to half the total. The sums reachable using the
+ * first i tracks are built for each i, then the chosen subset is recovered by
+ * working back through them.
+ * 
+ * @param tracks to partition.
+ * @param duration maximum length of a side.
+ * @param assignment updated with the side of each track, or left empty if the
+ * tracks cannot fit on two sides.
+ * @return true if the partition was solved.
+ * @return false if it needs too much memory.
+ */
+bool balanceTwoSides(const std::vector<Track> & tracks, size_t duration, Assignment & assignment)
+{
+    const size_t trackCount{tracks.size()};
+    size_t total{};
+    for (const auto & track : tracks)
+        total += track.getValue();
+
+    // Only sums up to half the total are needed for the shorter side.
+    const size_t half{total / 2};
+    const size_t words{(half + 64) / 64};
+    if ((trackCount + 1) * words > (16 << 20))
+        return false;
+
+    std::vector<Bits> reachable(trackCount + 1, Bits{half});
+    reachable[0].set(0);
+    for (size_t i = 0; i < trackCount; ++i)
+    {
+        reachable[i+1] = reachable[i];
+        reachable[i+1].include(reachable[i], tracks[i].getValue());
+    }
+
+    // Find the longest shorter side that leaves the longer side short enough.
+    const size_t shortest{total > duration ? total - duration : 0};
+    size_t seconds{half + 1};
+    while ((seconds-- > shortest) && (!reachable[trackCount].test(seconds)))
+        ;
+
+    assignment.clear();
+    if ((seconds == std::numeric_limits<size_t>::max()) || (seconds < shortest))
+        return true;
+
+    assignment.resize(trackCount, 1);
+    for (size_t i = trackCount; i > 0; --i)
+    {
+        if (reachable[i-1].test(seconds))
+            continue;
+
+        assignment[i-1] = 0;
+        seconds -= tracks[i-1].getValue();
+    }
+
+    return true;
+}
+
+/**
+ * @section Define Combiner class.
+ *
+ * Combiner implements the Complete Karmarkar-Karp algorithm. Like the largest
+ * differencing method, it repeatedly combines the two Tuples with the largest
+ * spread, but it tries every distinct way of pairing their subsets, starting
+ * with the Karmarkar-Karp choice, and prunes with bounds on the final score.
+ * 
+ * Like a Partial, a Tuple holds only the subsets containing tracks, longest
+ * first, the rest of the sides being empty. Two Tuples are combined by adding
+ * the subsets of the smaller one into the larger one in place, logging each
+ * change so that it can be undone when stepping back. The search keeps an
+ * explicit stack of Frames, one for each combination, so it never copies the
+ * Tuples and its depth is not limited by the call stack. The tracks in each
+ * subset are recorded as a tree of Groups, built as subsets are combined, so
+ * the search never copies track lists either.
+ */
+
+class Combiner
+{
+public:
+    Combiner(const std::vector<Track> & tracks, size_t sideCount, size_t duration, size_t goal, const Timer & timer);
+
+    bool search(size_t & score, Assignment & assignment);
+
+private:
+    static constexpr size_t none{std::numeric_limits<size_t>::max()};
+
+    struct Part
+    {
+        size_t seconds;
+        size_t group;
+    };
+    using Tuple = std::vector<Part>;
+
+    struct Group
+    {
+        size_t left;
+        size_t right;
+    };
+
+    // A subset of the larger Tuple grown by 'seconds', or added to it, then
+    // moved forward from 'from' to 'to' to keep the Tuple in order.
+    struct Change
+    {
+        size_t from;
+        size_t to;
+        size_t seconds;
+        bool added;
+    };
+
+    // The combination of two Tuples. The partner chosen for each subset of
+    // the smaller Tuple is held in 'choices' starting at 'choice', and the
+    // changes made to the larger Tuple in 'changes' starting at 'change'.
+    struct Frame
+    {
+        size_t first;
+        size_t second;
+        size_t large;
+        size_t small;
+        size_t choice;
+        size_t change;
+        size_t mark;
+        size_t slot;
+    };
+
+    size_t getShortest(size_t tuple) const;
+    size_t getSpread(size_t tuple) const { return tuples[tuple].front().seconds - getShortest(tuple); }
+
+    void look(void);
+    bool isPromising(void) const;
+    void evaluate(const Tuple & tuple);
+    size_t join(size_t left, size_t right);
+    void resolve(size_t group, size_t side);
+
+    void findRuns(const Tuple & tuple);
+    bool fill(const Frame & frame, size_t from);
+    bool advance(const Frame & frame);
+    void apply(Frame & frame);
+    void undo(const Frame & frame);
+
+    const std::vector<Track> & tracks;
+    const size_t sideCount;
+    const size_t duration;
+    const size_t goal;
+    const Timer & timer;
+    size_t total;
+
+    std::vector<Group> groups;
+    size_t incumbent;
+    bool improved;
+    Assignment best;
+
+    std::vector<Tuple> tuples;
+    std::vector<size_t> pending;    // Tuples still to combine, largest spread last.
+    size_t floor;                   // Sum of the shortest subset of each pending Tuple.
+    std::vector<Frame> frames;
+    std::vector<size_t> choices;
+    std::vector<Change> changes;
+
+    // Partners for the subsets of the smaller Tuple. Choice 0 is an empty
+    // side, and each other choice is a run of equal subsets of the larger
+    // Tuple, shortest first, starting at 'starts' with 'room' still free.
+    std::vector<size_t> starts;
+    std::vector<size_t> room;
+    std::vector<std::pair<size_t, size_t>> pairs;
+};
+
+Combiner::Combiner(const std::vector<Track> & trackList, size_t count, size_t dur, size_t target, const Timer & tim) :
+    tracks{trackList}, sideCount{count}, duration{dur}, goal{target}, timer{tim}, total{},
+    groups{}, incumbent{}, improved{}, best(trackList.size()),
+    tuples{}, pending{}, floor{}, frames{}, choices{}, changes{}, starts{}, room{}, pairs{}
+{
+    // Each track is a Group of its own.
+    groups.reserve(2 * tracks.size());
+    for (const auto & track : tracks)
+    {
+        groups.push_back({none, none});
+        total += track.getValue();
+    }
+}
+
+/**
+ * @brief Get the length of the shortest side of a Tuple, which is zero if
+ * any side is empty.
+ * 
+ * @param tuple index of the Tuple.
+ * @return size_t the length of the shortest side.
+ */
+size_t Combiner::getShortest(size_t tuple) const
+{
+    const Tuple & parts{tuples[tuple]};
+
+    return parts.size() < sideCount ? 0 : parts.back().seconds;
+}
+
+/**
+ * @brief Record that two Groups have been combined into one subset.
+ * 
+ * @param left Group, or none if the subset was empty.
+ * @param right Group, or none if the subset was empty.
+ * @return size_t the combined Group.
+ */
+size_t Combiner::join(size_t left, size_t right)
+{
+    if (left == none)
+        return right;
+
+    if (right == none)
+        return left;
+
+    groups.push_back({left, right});
+
+    return groups.size() - 1;
+}
+
+/**
+ * @brief Assign all the tracks of a Group to the given side.
+ * 
+ * @param group to assign.
+ * @param side index of the side.
+ */
+void Combiner::resolve(size_t group, size_t side)
+{
+    std::vector<size_t> stack{group};
+    while (!stack.empty())
+    {
+        const size_t index{stack.back()};
+        stack.pop_back();
+        if (index == none)
+            continue;
+
+        if (index < tracks.size())
+        {
+            best[index] = side;
+            continue;
+        }
+
+        stack.push_back(groups[index].left);
+        stack.push_back(groups[index].right);
+    }
+}
+
+/**
+ * @brief Score a complete partition and keep it if it is the best so far.
+ * 
+ * @param tuple holding every track.
+ */
+void Combiner::evaluate(const Tuple & tuple)
+{
+    size_t squares{};
+    for (const auto & part : tuple)
+    {
+        if (part.seconds > duration)
+            return;
+
+        squares += part.seconds * part.seconds;
+    }
+
+    const size_t latest{sideCount * squares - total * total};
+    if (latest >= incumbent)
+        return;
+
+    incumbent = latest;
+    improved = true;
+    for (size_t side = 0; side < tuple.size(); ++side)
+        resolve(tuple[side].group, side);
+}
+
+/**
+ * @brief Determine if combining the pending Tuples could produce a better
+ * partition than the best so far. Some side must end up at least as long as
+ * the largest spread plus the shortest subset of every Tuple. That side must
+ * fit, and the score is lowest if the other sides share the rest equally.
+ * 
+ * @return true if the search below this point is worth continuing.
+ * @return false otherwise.
+ */
+bool Combiner::isPromising(void) const
+{
+    const size_t longest{getSpread(pending.back()) + floor};
+    if (longest > duration)
+        return false;
+
+    if (longest * sideCount <= total)
+        return true;
+
+    const size_t rest{total - longest};
+    const size_t share{sideCount - 1};
+    const size_t lowest{sideCount * longest * longest + (sideCount * rest * rest + share - 1) / share};
+
+    return lowest - total * total < incumbent;
+}
+
+/**
+ * @brief Find the partners available in the given Tuple, which are the empty
+ * sides and each run of subsets of equal length. Subsets of equal length are
+ * interchangeable, so only the number taken from each run matters.
+ * 
+ * @param tuple to be combined into.
+ */
+void Combiner::findRuns(const Tuple & tuple)
+{
+    starts.assign(1, 0);
+    room.assign(1, sideCount - tuple.size());
+    for (size_t i = tuple.size(); i-- > 0; )
+    {
+        if ((i + 1 == tuple.size()) || (tuple[i].seconds != tuple[i+1].seconds))
+        {
+            starts.push_back(i);
+            room.push_back(1);
+        }
+        else
+        {
+            starts.back() = i;
+            ++room.back();
+        }
+    }
+}
+
+/**
+ * @brief Choose the shortest free partner for each subset of the smaller
+ * Tuple from the given one on, which for the first choice is the
+ * Karmarkar-Karp pairing. Subsets of equal length are interchangeable, so
+ * their partners are kept in order.
+ * 
+ * @param frame holding the choices.
+ * @param from first subset to choose for.
+ * @return true if every subset has a partner.
+ * @return false if there are not enough partners, leaving 'room' unchanged.
+ */
+bool Combiner::fill(const Frame & frame, size_t from)
+{
+    const Tuple & small{tuples[frame.small]};
+    size_t * const choice{&choices[frame.choice]};
+    for (size_t j = from; j < small.size(); ++j)
+    {
+        size_t c{((j) && (small[j].seconds == small[j-1].seconds)) ? choice[j-1] : 0};
+        while ((c < room.size()) && (!room[c]))
+            ++c;
+
+        if (c == room.size())
+        {
+            for (size_t k = from; k < j; ++k)
+                ++room[choice[k]];
+
+            return false;
+        }
+
+        choice[j] = c;
+        --room[c];
+    }
+
+    return true;
+}
+
+/**
+ * @brief Step to the next distinct way of pairing the subsets of the two
+ * Tuples, like std::next_permutation.
+ * 
+ * @param frame holding the choices.
+ * @return true if there is another way.
+ * @return false otherwise.
+ */
+bool Combiner::advance(const Frame & frame)
+{
+    findRuns(tuples[frame.large]);
+    const size_t count{tuples[frame.small].size()};
+    size_t * const choice{&choices[frame.choice]};
+    for (size_t j = 0; j < count; ++j)
+        --room[choice[j]];
+
+    for (size_t j = count; j-- > 0; )
+    {
+        ++room[choice[j]];
+        for (size_t c = choice[j] + 1; c < room.size(); ++c)
+        {
+            if (!room[c])
+                continue;
+
+            choice[j] = c;
+            --room[c];
+            if (fill(frame, j + 1))
+                return true;
+
+            ++room[c];
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Combine the two Tuples with the largest spread as chosen by the
+ * Frame, adding the subsets of the smaller Tuple into the larger one.
+ * 
+ * @param frame holding the choices, updated with the changes made.
+ */
+void Combiner::apply(Frame & frame)
+{
+    Tuple & large{tuples[frame.large]};
+    const Tuple & small{tuples[frame.small]};
+    frame.mark = groups.size();
+    frame.change = changes.size();
+    floor -= getShortest(frame.first) + getShortest(frame.second);
+
+    // Grow the subsets in position order, so that moving one forward leaves
+    // the positions still to grow unchanged.
+    findRuns(large);
+    pairs.clear();
+    for (size_t j = 0; j < small.size(); ++j)
+    {
+        const size_t c{choices[frame.choice + j]};
+        pairs.emplace_back(c ? starts[c] + --room[c] : none, j);
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    auto shorter = [](size_t seconds, const Part & part) { return seconds > part.seconds; };
+    for (const auto & [position, j] : pairs)
+    {
+        const Part & part{small[j]};
+        size_t from{position};
+        if (from == none)
+        {
+            from = large.size();
+            large.push_back(part);
+        }
+        else
+        {
+            large[from].seconds += part.seconds;
+            large[from].group = join(large[from].group, part.group);
+        }
+
+        const auto it{std::upper_bound(large.begin(), large.begin() + from, large[from].seconds, shorter)};
+        const size_t to(it - large.begin());
+        std::rotate(it, large.begin() + from, large.begin() + from + 1);
+        changes.push_back({from, to, part.seconds, position == none});
+    }
+
+    pending.pop_back();
+    pending.pop_back();
+    floor += getShortest(frame.large);
+
+    auto spread = [this](size_t seconds, size_t tuple) { return seconds < getSpread(tuple); };
+    const auto slot{std::upper_bound(pending.begin(), pending.end(), getSpread(frame.large), spread)};
+    frame.slot = slot - pending.begin();
+    pending.insert(slot, frame.large);
+}
+
+/**
+ * @brief Undo the combination made by the Frame, restoring both Tuples.
+ * 
+ * @param frame holding the changes made.
+ */
+void Combiner::undo(const Frame & frame)
+{
+    Tuple & large{tuples[frame.large]};
+    pending.erase(pending.begin() + frame.slot);
+    floor -= getShortest(frame.large);
+
+    while (changes.size() > frame.change)
+    {
+        const Change & change{changes.back()};
+        std::rotate(large.begin() + change.to, large.begin() + change.to + 1, large.begin() + change.from + 1);
+        if (change.added)
+        {
+            large.pop_back();
+        }
+        else
+        {
+            auto & part{large[change.from]};
+            part.seconds -= change.seconds;
+            part.group = groups[part.group].left;
+        }
+        changes.pop_back();
+    }
+    groups.resize(frame.mark);
+
+    pending.push_back(frame.second);
+    pending.push_back(frame.first);
+    floor += getShortest(frame.first) + getShortest(frame.second);
+}
+
+/**
+ * @brief Search depth first, combining the two Tuples with the largest spread
+ * at each step and stepping back to try the next way of combining them once
+ * everything below has been searched or pruned.
+ */
+void Combiner::look(void)
+{
+    frames.clear();
+    bool descend{true};
+    while ((timer.isWorking()) && (incumbent > goal))
+    {
+        if (descend)
+        {
+            if (pending.size() == 1)
+            {
+                evaluate(tuples[pending.back()]);
+            }
+            else if (isPromising())
+            {
+                Frame frame{};
+                frame.first = pending[pending.size() - 1];
+                frame.second = pending[pending.size() - 2];
+                const bool swap{tuples[frame.second].size() > tuples[frame.first].size()};
+                frame.large = swap ? frame.second : frame.first;
+                frame.small = swap ? frame.first : frame.second;
+                frame.choice = choices.size();
+                choices.resize(frame.choice + tuples[frame.small].size());
+
+                findRuns(tuples[frame.large]);
+                fill(frame, 0);
+                apply(frame);
+                frames.push_back(frame);
+
+                continue;
+            }
+        }
+
+        if (frames.empty())
+            break;
+
+        Frame & frame{frames.back()};
+        undo(frame);
+        descend = advance(frame);
+        if (descend)
+        {
+            apply(frame);
+
+            continue;
+        }
+
+        choices.resize(frame.choice);
+        frames.pop_back();
+    }
+}
+
+/**
+ * @brief Search for the partition with the lowest score.
+ * 
+ * @param score to beat, updated if a better partition is found.
+ * @param assignment updated with the side of each track if a better partition
+ * is found.
+ * @return true if a better partition was found.
+ * @return false otherwise.
+ */
+bool Combiner::search(size_t & score, Assignment & assignment)
+{
+    incumbent = score;
+    improved = false;
+
+    // Each track starts as a Tuple of its own.
+    const size_t trackCount{tracks.size()};
+    tuples.clear();
+    tuples.reserve(trackCount);
+    for (size_t i = 0; i < trackCount; ++i)
+        tuples.push_back(Tuple{Part{tracks[i].getValue(), i}});
+
+    pending.resize(trackCount);
+    for (size_t i = 0; i < trackCount; ++i)
+        pending[i] = trackCount - 1 - i;
+    auto spread = [this](size_t a, size_t b) { return getSpread(a) < getSpread(b); };
+    std::stable_sort(pending.begin(), pending.end(), spread);
+
+    floor = 0;
+    for (size_t tuple : pending)
+        floor += getShortest(tuple);
+
+    if (!pending.empty())
+        look();
+
+    if (!improved)
+        return false;
+
+    score = incumbent;
+    assignment = best;
+
+    return true;
+}
+
+/**
+ * @brief Partition the tracks across the sides using the Complete
+ * Karmarkar-Karp algorithm, which finds the partition with the lowest score
+ * if given enough time.
+ * 
+ * @param tracks to partition, longest first.
+ * @param sideCount number of sides.
+ * @param duration maximum length of a side.
+ * @param goal score at which to stop looking.
+ * @param timer limiting the time spent searching.
+ * @param score to beat, updated if a better partition is found.
+ * @param assignment updated with the side of each track if a better partition
+ * is found.
+ * @return true if a better partition was found.
+ * @return false otherwise.
+ */
+bool completeKarmarkarKarp(const std::vector<Track> & tracks, size_t sideCount, size_t duration,
+    size_t goal, const Timer & timer, size_t & score, Assignment & assignment)
+{
+    Combiner combiner{tracks, sideCount, duration, goal, timer};
+
+    return combiner.search(score, assignment);
+}
+
+
+/**
+ * @section Define Annealer class.
+ *
+ * Annealer improves an assignment by moving single tracks between sides and
+ * swapping pairs of tracks on different sides. Each move changes the lengths
+ * of two sides only, so its effect on the score is calculated in constant
+ * time. Moves that make the score worse are accepted with a probability that
+ * falls as the temperature cools, and the search restarts from the best
+ * assignment found each time the temperature has cooled.
+ */
+
+class Annealer
+{
+public:
+    Annealer(const std::vector<Track> & tracks, size_t sideCount, size_t duration, size_t goal, const Timer & timer);
+
+    bool search(size_t & score, Assignment & assignment);
+
+private:
+    static constexpr size_t cycle{1 << 17};
+
+    bool propose(size_t & track, size_t & other, size_t & side, long long & delta);
+    bool accept(long long delta, double temperature);
+    double calibrate(void);
+
+    const std::vector<Track> & tracks;
+    const size_t sideCount;
+    const size_t duration;
+    const size_t goal;
+    const Timer & timer;
+
+    std::mt19937_64 random;
+    std::vector<size_t> loads;
+    Assignment current;
+};
+
+Annealer::Annealer(const std::vector<Track> & trackList, size_t count, size_t dur, size_t target, const Timer & tim) :
+    tracks{trackList}, sideCount{count}, duration{dur}, goal{target}, timer{tim},
+    random{}, loads(count), current{}
+{
+}
+
+/**
+ * @brief Pick a random move, either moving a track to another side or swapping
+ * it with a track on another side.
+ * 
+ * @param track to move.
+ * @param other track to swap with, or the track count for a simple move.
+ * @param side the track is moved to.
+ * @param delta change to the sum of squares of the side lengths.
+ * @return true if the move keeps every side within the duration.
+ * @return false otherwise.
+ */
+bool Annealer::propose(size_t & track, size_t & other, size_t & side, long long & delta)
+{
+    const size_t trackCount{tracks.size()};
+    track = random() % trackCount;
+    const size_t from{current[track]};
+    long long seconds = tracks[track].getValue();
+
+    if (random() & 1)
+    {
+        other = trackCount;
+        side = random() % (sideCount - 1);
+        if (side >= from)
+            ++side;
+    }
+    else
+    {
+        other = random() % trackCount;
+        side = current[other];
+        if (side == from)
+            return false;
+
+        seconds -= (long long)tracks[other].getValue();
+    }
+
+    // Moving 'seconds' from one side to the other.
+    const long long source = loads[from];
+    const long long target = loads[side];
+    if ((target + seconds > (long long)duration) || (source - seconds > (long long)duration))
+        return false;
+
+    delta = 2 * seconds * (target - source + seconds);
+
+    return true;
+}
+
+bool Annealer::accept(long long delta, double temperature)
+{
+    if (delta <= 0)
+        return true;
+
+    std::uniform_real_distribution<double> chance{0.0, 1.0};
+
+    return chance(random) < std::exp(-delta / temperature);
+}
+
+/**
+ * @brief Choose a starting temperature from the average increase in the sum
+ * of squares caused by a sample of random moves.
+ * 
+ * @return double the starting temperature.
+ */
+double Annealer::calibrate(void)
+{
+    double increase{};
+    size_t count{};
+    for (int i = 0; i < 1000; ++i)
+    {
+        size_t track{}, other{}, side{};
+        long long delta{};
+        if ((propose(track, other, side, delta)) && (delta > 0))
+        {
+            increase += delta;
+            ++count;
+        }
+    }
+
+    return count ? increase / count : 1.0;
+}
+
+/**
+ * @brief Search for an assignment with a lower score until the timer expires.
+ * 
+ * @param score of the given assignment, updated if a better one is found.
+ * @param assignment to improve.
+ * @return true if a better assignment was found.
+ * @return false otherwise.
+ */
+bool Annealer::search(size_t & score, Assignment & assignment)
+{
+    if ((sideCount < 2) || (tracks.empty()))
+        return false;
+
+    size_t total{};
+    for (size_t track = 0; track < tracks.size(); ++track)
+    {
+        loads[assignment[track]] += tracks[track].getValue();
+        total += tracks[track].getValue();
+    }
+
+    size_t sum{};
+    size_t squares{};
+    sumLoads(loads.data(), sideCount, sum, squares);
+
+    current = assignment;
+    size_t lowest{squares};
+    const double start{calibrate()};
+    const double cooling{std::pow(1e-4, 1.0 / cycle)};
+    bool improved{};
+
+    while ((timer.isWorking()) && (sideCount * lowest - total * total > goal))
+    {
+        // Restart each cycle from the best assignment found.
+        current = assignment;
+        std::fill(loads.begin(), loads.end(), 0);
+        for (size_t track = 0; track < tracks.size(); ++track)
+            loads[current[track]] += tracks[track].getValue();
+        squares = lowest;
+
+        double temperature{start};
+        for (size_t i = 0; i < cycle; ++i, temperature *= cooling)
+        {
+            size_t track{}, other{}, side{};
+            long long delta{};
+            if ((!propose(track, other, side, delta)) || (!accept(delta, temperature)))
+                continue;
+
+            const size_t from{current[track]};
+            long long seconds = tracks[track].getValue();
+            if (other != tracks.size())
+            {
+                seconds -= (long long)tracks[other].getValue();
+                current[other] = from;
+            }
+            current[track] = side;
+            loads[from] -= seconds;
+            loads[side] += seconds;
+            squares += delta;
+
+            if (squares < lowest)
+            {
+                lowest = squares;
+                assignment = current;
+                improved = true;
+
+                if (sideCount * lowest - total * total <= goal)
+                    break;
+            }
+
+            if (((i & 1023) == 0) && (!timer.isWorking()))
+                break;
+        }
+    }
+
+    if (!improved)
+        return false;
+
+    score = sideCount * lowest - total * total;
+
+    return true;
+}
+
+/**
+ * @brief Improve the given assignment by simulated annealing until the timer
+ * expires or the goal is reached.
+ * 
+ * @param tracks being partitioned.
+ * @param sideCount number of sides.
+ * @param duration maximum length of a side.
+ * @param goal score at which to stop looking.
+ * @param timer limiting the time spent searching.
+ * @param score of the given assignment, updated if a better one is found.
+ * @param assignment to improve.
+ * @return true if a better assignment was found.
+ * @return false otherwise.
+ */
+bool improveAssignment(const std::vector<Track> & tracks, size_t sideCount, size_t duration,
+    size_t goal, const Timer & timer, size_t & score, Assignment & assignment)
+{
+    Annealer annealer{tracks, sideCount, duration, goal, timer};
+
+    return annealer.search(score, assignment);
+}
@@ -0,0 +1,50 @@
+/**
+ * @file    Partition.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'TrackSort' is a command-line utility for splitting tracks across multiple
+ * sides.
+ *
+ * Number partitioning interfaces for the track shuffler.
+ */
+
+#if !defined _PARTITION_H_INCLUDED_
+#define _PARTITION_H_INCLUDED_
+
+#include <vector>
+
+#include "Side.h"
+#include "Utilities.h"
+
+/**
+ * @section number partitioning code.
+ *
+ * An Assignment holds the index of the side each track is placed on.
+ */
+
+using Assignment = std::vector<size_t>;
+
+extern Assignment karmarkarKarp(const std::vector<Track> & tracks, size_t sideCount);
+extern bool balanceTwoSides(const std::vector<Track> & tracks, size_t duration, Assignment & assignment);
+extern bool completeKarmarkarKarp(const std::vector<Track> & tracks, size_t sideCount, size_t duration,
+    size_t goal, const Timer & timer, size_t & score, Assignment & assignment);
+extern bool improveAssignment(const std::vector<Track> & tracks, size_t sideCount, size_t duration,
+    size_t goal, const Timer & timer, size_t & score, Assignment & assignment);
+
+#endif //!defined _PARTITION_H_INCLUDED_
@@ -28,9 +28,25 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <numeric>
+#include <memory>
+#include <array>
+#include <type_traits>
+#include <csignal>
+#include <fstream>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <chrono>
 
 #include "Side.h"
 #include "Utilities.h"
+#include "Partition.h"
+#include "Packing.h"
 #include "Configuration.h"
 
 
@@ -47,9 +63,10 @@ template<typename T=int>
 class Indexer
 {
 public:
-    Indexer(T first, T limit);
-    T operator()(void) const { return index; }
-    T inc();
+    constexpr Indexer(T first, T limit);
+    constexpr T operator()(void) const { return index; }
+    constexpr T inc();
+    constexpr T at(T count) const;
 
 private:
     T step, index, start, end;
@@ -63,7 +80,7 @@ private:
  * @param limit maximum index.
  */
 template<typename T>
-Indexer<T>::Indexer(T first, T limit) :
+constexpr Indexer<T>::Indexer(T first, T limit) :
     step{1}, index{(first / 2) % limit}, start{0}, end{limit-1}
 {
     if (first & 1)
@@ -81,7 +98,7 @@ Indexer<T>::Indexer(T first, T limit) :
  * @return T the new index.
  */
 template<typename T>
-T Indexer<T>::inc()
+constexpr T Indexer<T>::inc()
 {
     if (index == end)
         index = start;
@@ -91,228 +108,1831 @@ T Indexer<T>::inc()
     return index;
 }
 
+/**
+ * @brief Get the index after a number of increments without changing it.
+ * 
+ * @tparam T numeric type to use for index (int by default)
+ * @param count number of increments, less than the limit.
+ * @return T the index after 'count' increments.
+ */
+template<typename T>
+constexpr T Indexer<T>::at(T count) const
+{
+    const T limit{std::max(start, end) + 1};
+    const T value{index + (step > 0 ? count : limit - count)};
+
+    return value < limit ? value : value - limit;
+}
+
+
+/**
+ * @brief The side of each track. Thirty two bits hold the side of any track
+ * list that fits in memory, while keeping the array compact.
+ */
+using Placement = std::vector<uint32_t>;
+
+
+/**
+ * @brief Calculate the lowest possible sum of the squares of a number of side
+ * lengths with the given total, when every length is a multiple of 'unit'.
+ * 
+ * @param total of the side lengths.
+ * @param count number of sides.
+ * @param unit that all the lengths are a multiple of.
+ * @return size_t the lowest sum of squares.
+ */
+static size_t balancedSquares(size_t total, size_t count, size_t unit)
+{
+    const size_t units{total / unit};
+    const size_t share{units / count};
+    const size_t extra{units % count};
+
+    return unit * unit * ((count - extra) * share * share + extra * (share + 1) * (share + 1));
+}
+
+
+/**
+ * @brief The number of milliseconds between checkpoints of the search.
+ */
+static const size_t checkpointPeriod{60000};
+
+/**
+ * @brief Set when the process is asked to terminate, so that the search can
+ * save a checkpoint before it stops.
+ */
+static std::atomic<bool> interrupted{};
+
+static void interrupt(int)
+{
+    interrupted.store(true, std::memory_order_relaxed);
+}
+
+
+/**
+ * @section Define Table class.
+ *
+ * Table is a fixed size transposition table shared by all the workers. It
+ * records partial assignments whose search has been completed, along with a
+ * score that none of their solutions can beat. Entries are keyed by a hash of
+ * the track index and the side lengths. The hash is a sum of a mix of each side
+ * length, so it does not depend on the order of the sides and can be updated
+ * as each track is added or removed. Each entry is two words with the key XORed
+ * with the score, so an entry torn by another thread is detected and ignored.
+ */
+
+class Table
+{
+public:
+    Table(void) : mask{}, slots{nullptr, std::free} {}
+
+    void allocate(size_t bytes);
+    bool isRefuted(uint64_t key, size_t incumbent) const;
+    void store(uint64_t key, size_t bound);
+
+    static uint64_t mix(uint64_t value);
+
+private:
+    size_t mask;
+    std::unique_ptr<uint64_t[], decltype(&std::free)> slots;
+};
+
+/**
+ * @brief Allocate the largest table that fits in the given memory.
+ * 
+ * @param bytes of memory available.
+ */
+void Table::allocate(size_t bytes)
+{
+    // Compare against the quotient so that doubling cannot overflow.
+    size_t count{1};
+    while (count <= bytes / (2 * 2 * sizeof(uint64_t)))
+        count *= 2;
+
+    if (count * 2 * sizeof(uint64_t) > bytes)
+        count = 0;
+
+    mask = count ? count - 1 : 0;
+    // Zeroed memory is taken from the system a page at a time as it is used,
+    // so a large table costs nothing up front.
+    slots.reset(count ? static_cast<uint64_t *>(std::calloc(2 * count, sizeof(uint64_t))) : nullptr);
+}
+
+/**
+ * @brief Determine if the search from the given key is known not to beat the
+ * best score so far.
+ * 
+ * @param key of the partial assignment.
+ * @param incumbent best score so far.
+ * @return true if the search can be skipped.
+ * @return false otherwise.
+ */
+bool Table::isRefuted(uint64_t key, size_t incumbent) const
+{
+    if (!slots)
+        return false;
+
+    const size_t index{2 * (key & mask)};
+    const uint64_t check{std::atomic_ref<uint64_t>{slots[index]}.load(std::memory_order_relaxed)};
+    const uint64_t bound{std::atomic_ref<uint64_t>{slots[index + 1]}.load(std::memory_order_relaxed)};
+
+    return ((check ^ bound) == key) && (bound >= incumbent);
+}
+
+/**
+ * @brief Record that no solution from the given key beats the given score.
+ * 
+ * @param key of the partial assignment.
+ * @param bound score that the solutions cannot beat.
+ */
+void Table::store(uint64_t key, size_t bound)
+{
+    if (!slots)
+        return;
+
+    const size_t index{2 * (key & mask)};
+    std::atomic_ref<uint64_t>{slots[index]}.store(key ^ bound, std::memory_order_relaxed);
+    std::atomic_ref<uint64_t>{slots[index + 1]}.store(bound, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Mix the bits of a value to give a well distributed hash.
+ * 
+ * @param value to mix.
+ * @return uint64_t the mixed value.
+ */
+uint64_t Table::mix(uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+
+    return value ^ (value >> 31);
+}
+
+
+/**
+ * @section Define Index class.
+ *
+ * Index maps side lengths to an entry number, using open addressing with
+ * linear probing. The slots are allocated once, big enough for every length
+ * that can be held at the same time, so a search step never allocates. Empty
+ * slots hold an entry of -1, and removing a length shifts the lengths after it
+ * back, so no deleted markers are left behind.
+ */
+
+class Index
+{
+public:
+    Index(void) : mask{}, slots{} {}
+
+    void reserve(size_t count);
+    int & at(size_t seconds);
+    void erase(size_t seconds);
+
+private:
+    struct Slot
+    {
+        size_t seconds;
+        int entry;
+    };
+
+    size_t home(size_t seconds) const { return Table::mix(seconds) & mask; }
+
+    size_t mask;
+    std::vector<Slot> slots;
+};
+
+/**
+ * @brief Allocate slots for at least twice the given number of lengths.
+ * 
+ * @param count most lengths held at the same time.
+ */
+void Index::reserve(size_t count)
+{
+    size_t size{1};
+    while (size < 2 * count)
+        size *= 2;
+
+    mask = size - 1;
+    slots.assign(size, Slot{0, -1});
+}
+
+/**
+ * @brief Get the entry for a length, claiming an empty slot for it if it is
+ * not held, in which case the entry is -1 and must be set.
+ * 
+ * @param seconds length to look up.
+ * @return int& the entry for the length.
+ */
+int & Index::at(size_t seconds)
+{
+    size_t i{home(seconds)};
+    while ((slots[i].entry >= 0) && (slots[i].seconds != seconds))
+        i = (i + 1) & mask;
+
+    slots[i].seconds = seconds;
+
+    return slots[i].entry;
+}
+
+/**
+ * @brief Remove a length, moving back any length after it that would
+ * otherwise no longer be found.
+ * 
+ * @param seconds length to remove, which must be held.
+ */
+void Index::erase(size_t seconds)
+{
+    size_t i{home(seconds)};
+    while ((slots[i].entry < 0) || (slots[i].seconds != seconds))
+        i = (i + 1) & mask;
+
+    for (size_t j = (i + 1) & mask; slots[j].entry >= 0; j = (j + 1) & mask)
+    {
+        // Move the length back unless its home lies after the gap.
+        if (((j - home(slots[j].seconds)) & mask) >= ((j - i) & mask))
+        {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
+
+    slots[i].entry = -1;
+}
+
+
+/**
+ * @section Define Task class.
+ *
+ * A Task is a partial assignment of the first tracks to sides. Tasks are
+ * numbered in search order so that equally good solutions found by different
+ * workers are resolved the same way as the sequential search. A solution is
+ * ranked by the order of the task that found it plus one, so seeds, ranked
+ * 0, come before any solution found by the search. The tasks not
+ * yet searched form the frontier of the search, which is all that is needed
+ * to carry on from where a stopped search left off. A task stopped part way
+ * through also holds how many sides each of the following tracks has tried,
+ * so it carries on exactly where it stopped.
+ */
+
+struct Task
+{
+    size_t order;
+    std::vector<int> prefix;
+    std::vector<int> tried;
+};
+
+
+/**
+ * @section Define Worker class.
+ *
+ * A Worker holds the search state of a single thread. The running sum and sum
+ * of squares of the side lengths are kept up to date as tracks are added and
+ * removed, so a solution is scored in constant time. The score is the number
+ * of sides multiplied by the sum of squares, less the square of the sum, which
+ * is the variance scaled by the square of the number of sides. Scores are
+ * exact integers and only need a square root to give the deviation reported.
+ * 
+ * The side state is kept flat, with the length of each side in one array and
+ * the side of each track in another, so a search step touches little memory
+ * and never allocates.
+ * 
+ * The search is iterative. The stack holds a Frame for each track placed, with
+ * how many sides have been tried and the side the track is currently on, so
+ * the search can be stopped and inspected at any point.
+ * 
+ * The number of sides 'N' is a template parameter, so the common side counts
+ * get a search with fixed size loops over a std::array of side lengths and the
+ * visiting order of the sides looked up in a table built at compile time. An
+ * 'N' of 0 gives the generic search for any number of sides.
+ */
+
+class Finder;
+
+class Searcher
+{
+public:
+    Searcher(size_t trackCount) : probes{}, hits{}, score{std::numeric_limits<size_t>::max()}, found{}, best(trackCount) {}
+    virtual ~Searcher(void) {}
+
+    virtual void run(const Task & task, std::vector<Task> & rest) = 0;
+    virtual void branch(const Task & task, std::vector<Task> & tasks) = 0;
+
+    size_t getScore(void) const { return score; }
+    size_t getOrder(void) const { return found; }
+    const Placement & getBest(void) const { return best; }
+    size_t getProbes(void) const { return probes; }
+    size_t getHits(void) const { return hits; }
+    void clearCounts(void) { probes = 0; hits = 0; }
+
+protected:
+    size_t probes;
+    size_t hits;
+
+    size_t score;
+    size_t found;
+    Placement best;
+};
+
+/**
+ * @brief Build the visiting order of 'N' sides for every track, using an
+ * Indexer. The order only depends on the track index modulo twice 'N'.
+ * 
+ * @tparam N number of sides.
+ * @return the side visited after a number of sides have been tried, for each
+ * track index modulo twice 'N'.
+ */
+template<size_t N>
+static constexpr auto makeOrders(void)
+{
+    std::array<std::array<uint8_t, N>, 2 * N> orders{};
+    for (size_t track = 0; track < 2 * N; ++track)
+    {
+        Indexer side{(int)track, (int)N};
+        for (size_t count = 0; count < N; ++count, side.inc())
+            orders[track][count] = side();
+    }
+
+    return orders;
+}
+
+template<size_t N>
+class Worker : public Searcher
+{
+public:
+    Worker(Finder & owner);
+
+    void run(const Task & task, std::vector<Task> & rest) override;
+    void branch(const Task & task, std::vector<Task> & tasks) override;
+
+private:
+    using Loads = std::conditional_t<N == 0, std::vector<size_t>, std::array<size_t, N>>;
+
+    static constexpr auto orders{makeOrders<N>()};
+    static constexpr int scan{48};  // Most sides compared one by one for repeats.
+
+    struct Frame
+    {
+        int tried;
+        int placed;
+        int first;
+        uint64_t key;
+    };
+
+    // A side length tried by a Frame, and the index of the entry for the same
+    // length tried by an earlier Frame, or -1.
+    struct Tried
+    {
+        size_t seconds;
+        int previous;
+    };
+
+    int getCount(void) const;
+    int getSide(int track, int count) const;
+    void resume(const Task & task);
+    void look(int track);
+    void descend(int track);
+    void suspend(const Task & task, std::vector<Task> & rest);
+    bool isPromising(int track) const;
+    bool isRepeat(int track, int count, size_t seconds);
+    bool isCandidate(int track, int count, int side);
+    void forget(int first);
+    void load(const Task & task);
+    void unload(void);
+    void push(int side, int track);
+    void pop(int side, int track);
+    bool snapshot(size_t latest);
+
+    Finder & finder;
+    Loads loads;
+    std::vector<Indexer<int>> indexers;
+    Placement placement;
+    std::vector<Frame> stack;
+    std::vector<Tried> seen;
+    Index latest;
+    size_t order;
+    size_t sum;
+    size_t squares;
+    uint64_t hash;
+};
+
+
+/**
+ * @section Define Finder class.
+ *
+ */
+
+class Finder
+{
+public:
+    Finder(const std::vector<Track> &, const size_t, const size_t, const size_t, const size_t, const size_t);
+    ~Finder(void);
+
+    void setGoal(double target, double gap);
+    void enableStream(std::chrono::steady_clock::time_point start) { streaming = true; origin = start; }
+    void setCheckpoint(const std::filesystem::path & file) { checkpoint = file; }
+    bool restore(void);
+    bool seed(const Assignment & assignment, size_t rank = 0);
+    bool addTracksToSides(void);
+    bool combineTracks(void);
+    bool partitionTracks(void);
+    bool isSuccessful(void) const { return success; }
+    bool isFound(void) const { return score != std::numeric_limits<size_t>::max(); }
+    bool show(std::ostream & os) const;
+    double getLowest(void) const { return std::sqrt((double)lowest) / sideCount; }
+    Sides getSides(const Placement & placement) const;
+    bool showAll(std::ostream & os, bool plain=false, bool csv=false) const;
+
+private:
+    template<size_t N> friend class Worker;
+
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    struct Incumbent
+    {
+        size_t score;
+        size_t rank;
+        const Incumbent * previous;
+    };
+
+    void polish(void);
+    std::vector<Task> split(void);
+    void deal(std::vector<Task> & tasks);
+    void gather(void);
+    void save(void);
+    uint64_t fingerprint(void) const;
+    bool isStopped(size_t rank) const;
+    template<size_t N> void hire(void);
+    void work(size_t id);
+    bool take(size_t id, Task & task);
+    const Incumbent & getLeading(void) const { return *incumbent.load(std::memory_order_acquire); }
+    size_t getIncumbent(void) const { return getLeading().score; }
+    size_t getCutoff(size_t rank) const;
+    bool improve(size_t latest, size_t rank);
+    void publish(size_t latest, size_t rank, const Placement & placement);
+
+    const size_t duration;
+    const size_t sideCount;
+    const size_t trackCount;
+    const size_t jobs;
+    const size_t timeout;
+    const size_t memory;
+    size_t total;
+
+    bool forward;
+    int trackIndex;
+    int sideIndex;
+    bool success;
+
+    const std::vector<Track> & tracks;
+    std::vector<size_t> lengths;
+    std::vector<size_t> remainder;
+    std::vector<std::unique_ptr<Searcher>> workers;
+    std::vector<Queue> queues;
+    std::atomic<const Incumbent *> incumbent;
+    size_t lowest;
+    size_t goal;
+    Table table;
+    size_t probes;
+    size_t hits;
+
+    bool streaming;
+    std::mutex publishing;
+    size_t published;
+    size_t publishedRank;
+    std::chrono::steady_clock::time_point origin;
+
+    std::filesystem::path checkpoint;
+    bool resumed;
+    std::mutex deferring;
+    std::vector<Task> frontier;
+    Timer epoch;
+
+    size_t score;
+    size_t rank;
+    double dev;
+    Placement best;
+    Timer timer;
+};
+
+Finder::Finder(const std::vector<Track> & trackList, const size_t dur, const size_t tim, const size_t count, const size_t threads, const size_t megabytes) :
+    duration{dur}, sideCount{count}, trackCount{trackList.size()}, jobs{std::max(threads, (size_t)1)}, timeout{tim}, memory{megabytes}, total{},
+    forward{true}, trackIndex{}, sideIndex{}, success{}, tracks{trackList}, lengths{}, remainder{}, workers{}, queues(jobs),
+    incumbent{new Incumbent{std::numeric_limits<size_t>::max(), 0, nullptr}}, lowest{}, goal{}, table{}, probes{}, hits{},
+    streaming{}, publishing{}, published{std::numeric_limits<size_t>::max()}, publishedRank{}, origin{std::chrono::steady_clock::now()},
+    checkpoint{}, resumed{}, deferring{}, frontier{}, epoch{checkpointPeriod},
+    score{std::numeric_limits<size_t>::max()}, rank{}, dev{std::numeric_limits<double>::max()}, best(trackCount), timer{tim}
+{
+
+    lengths.reserve(trackCount);
+    for (const auto & track : tracks)
+        lengths.push_back(track.getValue());
+
+    // Calculate the total length of the tracks from each index to the end.
+    remainder.resize(trackCount + 1);
+    for (int i = trackCount; i > 0; --i)
+        remainder[i-1] = remainder[i] + lengths[i-1];
+    total = remainder[0];
+
+    // Calculate the lowest possible score. Every side length is a multiple of
+    // the greatest common divisor of the track lengths and the side holding
+    // the longest track is at least that long.
+    size_t unit{};
+    for (const auto & track : tracks)
+        unit = std::gcd(unit, track.getValue());
+
+    size_t squares{};
+    if (unit)
+    {
+        squares = balancedSquares(total, sideCount, unit);
+
+        const size_t longest{tracks[0].getValue()};
+        if ((sideCount > 1) && (longest * sideCount > total))
+            squares = std::max(squares, longest * longest + balancedSquares(total - longest, sideCount - 1, unit));
+    }
+    lowest = sideCount * squares - total * total;
+    goal = lowest;
+
+    // Use the search built for the number of sides if there is one.
+    switch (sideCount)
+    {
+    case 2: hire<2>(); break;
+    case 4: hire<4>(); break;
+    case 6: hire<6>(); break;
+    case 8: hire<8>(); break;
+    default: hire<0>(); break;
+    }
+}
+
+Finder::~Finder(void)
+{
+    // Every Incumbent published is reachable from the latest one.
+    for (const Incumbent * next = incumbent.load(); next; )
+    {
+        const Incumbent * previous{next->previous};
+        delete next;
+        next = previous;
+    }
+}
+
+/**
+ * @brief Create the workers using the search built for 'N' sides.
+ * 
+ * @tparam N number of sides, or 0 for the generic search.
+ */
+template<size_t N>
+void Finder::hire(void)
+{
+    workers.reserve(jobs);
+    for (size_t i = 0; i < jobs; ++i)
+        workers.push_back(std::make_unique<Worker<N>>(*this));
+}
+
+/**
+ * @brief Replace the solution shared by all workers if the latest is better,
+ * or as good and earlier in search order. The score and rank are published
+ * together as a new Incumbent, swapped in with a compare and exchange, so no
+ * lock is taken and a worker always reads a matching score and rank.
+ * 
+ * @param latest score of a newly found solution.
+ * @param rank of the solution.
+ * @return true if the latest solution is the best so far.
+ * @return false otherwise.
+ */
+bool Finder::improve(size_t latest, size_t rank)
+{
+    auto next{std::make_unique<Incumbent>(Incumbent{latest, rank, incumbent.load(std::memory_order_acquire)})};
+    auto isBetter = [latest, rank](const Incumbent * current)
+        { return (latest < current->score) || ((latest == current->score) && (rank < current->rank)); };
+
+    // On failure the exchange loads the Incumbent that got in first.
+    while (isBetter(next->previous))
+    {
+        if (incumbent.compare_exchange_weak(next->previous, next.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            next.release();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Get the score a solution of the given rank must be below to be
+ * worth finding. A solution as good as the best so far is still worth
+ * finding if it is earlier in search order.
+ * 
+ * @param rank of the solutions being looked for.
+ * @return size_t the score to beat.
+ */
+size_t Finder::getCutoff(size_t rank) const
+{
+    const auto & leading{getLeading()};
+
+    return leading.score + (rank < leading.rank ? 1 : 0);
+}
+
+/**
+ * @brief If streaming, write a newly found best solution to standard output
+ * as a single line of JSON, so that it can be used before the search ends.
+ * 
+ * @param latest score of the solution.
+ * @param rank of the solution.
+ * @param placement side of each track.
+ */
+void Finder::publish(size_t latest, size_t rank, const Placement & placement)
+{
+    if (!streaming)
+        return;
+
+    std::lock_guard<std::mutex> guard{publishing};
+
+    // Another thread may have published a better solution first.
+    if ((latest > published) || ((latest == published) && (rank >= publishedRank)))
+        return;
+
+    published = latest;
+    publishedRank = rank;
+
+    const auto elapsed{std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - origin).count()};
+
+    std::string line{"{\"deviation\":" + std::to_string(std::sqrt((double)latest) / sideCount)};
+    line += ",\"elapsed_ms\":" + std::to_string(elapsed) + ",\"sides\":[";
+    const auto sides{getSides(placement)};
+    for (size_t i = 0; i < sides.size(); ++i)
+    {
+        if (i)
+            line += ',';
+        line += sides[i].toJSON();
+    }
+    line += "]}\n";
+
+    std::cout << line << std::flush;
+}
+
+/**
+ * @brief Set the goal at which to stop looking, which is never below the
+ * lowest possible score.
+ * 
+ * @param target deviation that is good enough.
+ * @param gap from the lowest possible deviation that is good enough.
+ */
+void Finder::setGoal(double target, double gap)
+{
+    auto toScore = [this](double deviation) { return (size_t)std::floor(std::pow(deviation * sideCount, 2)); };
+
+    goal = std::max({lowest, toScore(target), toScore(getLowest() + gap)});
+}
+
+/**
+ * @brief Adopt the given assignment as the best solution so far if all the
+ * sides fit and it beats the current best. This gives the search a strong
+ * solution to prune against from the start.
+ * 
+ * @param assignment side of each track.
+ * @param order rank of the assignment, which is 0 unless it was found by the
+ * search.
+ * @return true if the assignment was adopted.
+ * @return false otherwise.
+ */
+bool Finder::seed(const Assignment & assignment, size_t order)
+{
+    std::vector<size_t> loads(sideCount);
+    for (size_t track = 0; track < trackCount; ++track)
+        loads[assignment[track]] += lengths[track];
+
+    if (*std::max_element(loads.begin(), loads.end()) > duration)
+        return false;
+
+    size_t sum{};
+    size_t squares{};
+    sumLoads(loads.data(), sideCount, sum, squares);
+
+    const size_t latest{sideCount * squares - total * total};
+    if (latest >= score)
+        return false;
+
+    score = latest;
+    rank = order;
+    dev = std::sqrt((double)score) / sideCount;
+    std::copy(assignment.begin(), assignment.end(), best.begin());
+    if (improve(latest, rank))
+        publish(latest, rank, best);
+
+    return true;
+}
+
+/**
+ * @brief Split the top levels of the search into enough tasks to keep all the
+ * workers busy. The tasks are generated in the order the sequential search
+ * would visit them.
+ * 
+ * @return std::vector<Task> the list of tasks in search order.
+ */
+std::vector<Task> Finder::split(void)
+{
+    const size_t wanted{jobs == 1 ? 1 : jobs * 8};
+
+    std::vector<Task> tasks(1);
+    for (size_t depth = 0; (depth < trackCount) && (tasks.size() < wanted); ++depth)
+    {
+        std::vector<Task> next{};
+        for (const auto & task : tasks)
+            workers[0]->branch(task, next);
+
+        tasks = std::move(next);
+    }
+
+    for (size_t i = 0; i < tasks.size(); ++i)
+        tasks[i].order = i;
+
+    return tasks;
+}
+
+/**
+ * @brief Take the next task for the given worker. A worker takes the earliest
+ * task from its own queue, and when that is empty it steals the latest task
+ * from the queue of another worker.
+ * 
+ * @param id of the worker.
+ * @param task taken.
+ * @return true if a task was taken.
+ * @return false if there is no work left.
+ */
+bool Finder::take(size_t id, Task & task)
+{
+    {
+        auto & queue{queues[id]};
+        std::lock_guard<std::mutex> lock(queue.lock);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < jobs; ++i)
+    {
+        auto & queue{queues[(id + i) % jobs]};
+        std::lock_guard<std::mutex> lock(queue.lock);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Determine if the workers should stop, either because the time is up,
+ * a checkpoint is due, the process is terminating or the goal is reached.
+ * 
+ * @return true if the workers should stop.
+ * @return false otherwise.
+ */
+bool Finder::isStopped(size_t rank) const
+{
+    if (!timer.isWorking())
+        return true;
+
+    // Once the goal is reached, only earlier tasks may find as good a solution.
+    const auto & leading{getLeading()};
+    if ((leading.score <= goal) && (leading.rank <= rank))
+        return true;
+
+    if (checkpoint.empty())
+        return false;
+
+    return (!epoch.isWorking()) || (interrupted.load(std::memory_order_relaxed));
+}
+
+void Finder::work(size_t id)
+{
+    std::vector<Task> rest{};
+    Task task{};
+    while (take(id, task))
+    {
+        if (isStopped(task.order + 1))
+            rest.push_back(std::move(task));
+        else
+            workers[id]->run(task, rest);
+    }
+
+    std::lock_guard<std::mutex> lock(deferring);
+    for (auto & task : rest)
+        frontier.push_back(std::move(task));
+}
+
+/**
+ * @brief Deal the tasks out to the workers.
+ * 
+ * @param tasks to deal, in search order.
+ */
+void Finder::deal(std::vector<Task> & tasks)
+{
+    for (auto & task : tasks)
+        queues[task.order % jobs].tasks.push_back(std::move(task));
+
+    tasks.clear();
+}
+
+/**
+ * @brief Gather the tasks not yet searched into the frontier in search order,
+ * and merge the best solutions found by the workers, favouring the earliest
+ * in search order.
+ */
+void Finder::gather(void)
+{
+    for (auto & queue : queues)
+    {
+        for (auto & task : queue.tasks)
+            frontier.push_back(std::move(task));
+
+        queue.tasks.clear();
+    }
+
+    auto comp = [](const Task & a, const Task & b) { return a.order < b.order; };
+    std::stable_sort(frontier.begin(), frontier.end(), comp);
+
+    for (auto & worker : workers)
+    {
+        probes += worker->getProbes();
+        hits += worker->getHits();
+        worker->clearCounts();
+
+        const auto latest{worker->getScore()};
+        const auto order{worker->getOrder() + 1};
+        if ((latest < score) || ((latest == score) && (order < rank)))
+        {
+            score = latest;
+            rank = order;
+            best = worker->getBest();
+        }
+    }
+    dev = std::sqrt((double)score) / sideCount;
+}
+
+/**
+ * @brief Write the checkpoint file, holding the best solution so far, the
+ * counters and the frontier of the search. The file is written to a temporary
+ * name first, so an interruption never leaves a damaged checkpoint.
+ */
+void Finder::save(void)
+{
+    if (checkpoint.empty())
+        return;
+
+    auto temporary{checkpoint};
+    temporary += ".tmp";
+    {
+        std::ofstream file{temporary};
+
+        file << "TrackSort checkpoint\n";
+        file << "fingerprint " << fingerprint() << '\n';
+        file << "sides " << sideCount << '\n';
+        file << "counts " << probes << ' ' << hits << '\n';
+
+        file << "best " << (isFound() ? trackCount : 0);
+        if (isFound())
+            for (const auto & side : best)
+                file << ' ' << side;
+        file << '\n';
+        file << "rank " << rank << '\n';
+
+        file << "frontier " << frontier.size() << '\n';
+        for (const auto & task : frontier)
+        {
+            file << task.order << ' ' << task.prefix.size();
+            for (const auto & side : task.prefix)
+                file << ' ' << side;
+            file << ' ' << task.tried.size();
+            for (const auto & count : task.tried)
+                file << ' ' << count;
+            file << '\n';
+        }
+
+        if (!file)
+        {
+            std::cerr << "Unable to write checkpoint " << temporary << '\n';
+
+            return;
+        }
+    }
+
+    std::error_code error{};
+    std::filesystem::rename(temporary, checkpoint, error);
+    if (error)
+        std::cerr << "Unable to write checkpoint " << checkpoint << ": " << error.message() << '\n';
+    else if (Configuration::isDebug())
+        std::cout << "Checkpoint written with " << frontier.size() << " tasks\n";
+}
+
+/**
+ * @brief Read the checkpoint file and carry on from where it left off. The
+ * best solution is adopted and the frontier replaces the initial tasks, so no
+ * part of the search is repeated.
+ * 
+ * @return true if the checkpoint was read.
+ * @return false if it could not be read or is for a different search.
+ */
+bool Finder::restore(void)
+{
+    std::ifstream file{checkpoint};
+    std::string word{};
+    std::string name{};
+    uint64_t print{};
+
+    file >> name >> word;
+    if ((!file) || (name != "TrackSort") || (word != "checkpoint"))
+    {
+        std::cerr << "Unable to read checkpoint " << checkpoint << '\n';
+
+        return false;
+    }
+
+    size_t sides{};
+    file >> word >> print >> word >> sides;
+    if ((!file) || (print != fingerprint()) || (sides != sideCount))
+    {
+        std::cerr << "Checkpoint " << checkpoint << " is for a different search\n";
+
+        return false;
+    }
+
+    // Every track and side index read is checked, so a damaged file cannot
+    // place a track on a side that does not exist.
+    size_t count{};
+    file >> word >> probes >> hits >> word >> count;
+
+    bool valid{(count == 0) || (count == trackCount)};
+    Assignment assignment(valid ? count : 0);
+    for (auto & side : assignment)
+    {
+        file >> side;
+        valid = valid && (side < sideCount);
+    }
+
+    size_t order{};
+    file >> word >> order;
+
+    file >> word >> count;
+    std::vector<Task> tasks{};
+    for (size_t i = 0; (valid) && (file) && (i < count); ++i)
+    {
+        Task task{};
+        size_t length{};
+        file >> task.order >> length;
+        valid = (length <= trackCount);
+
+        task.prefix.resize(valid ? length : 0);
+        for (auto & side : task.prefix)
+        {
+            file >> side;
+            valid = valid && (side >= 0) && (side < (int)sideCount);
+        }
+
+        file >> length;
+        valid = valid && (length <= trackCount - task.prefix.size());
+
+        task.tried.resize(valid ? length : 0);
+        for (auto & tried : task.tried)
+        {
+            file >> tried;
+            valid = valid && (tried >= 0) && (tried <= (int)sideCount);
+        }
+
+        tasks.push_back(std::move(task));
+    }
+
+    if (!file)
+    {
+        std::cerr << "Checkpoint " << checkpoint << " is incomplete\n";
+
+        return false;
+    }
+
+    if (!valid)
+    {
+        std::cerr << "Checkpoint " << checkpoint << " is damaged\n";
+
+        return false;
+    }
+
+    if (!assignment.empty())
+        seed(assignment, order);
+
+    frontier = std::move(tasks);
+    resumed = true;
+
+    return true;
+}
+
+/**
+ * @brief Identify the search by mixing the track lengths, the number of sides
+ * and the maximum side length, so a checkpoint is only used for the search
+ * that wrote it.
+ * 
+ * @return uint64_t the fingerprint of the search.
+ */
+uint64_t Finder::fingerprint(void) const
+{
+    uint64_t print{Table::mix(sideCount) ^ Table::mix(duration + trackCount)};
+    for (const auto & track : tracks)
+        print = Table::mix(print + track.getValue());
+
+    return print;
+}
+
+/**
+ * @brief Spend the time held back from the search improving the best solution
+ * with local moves.
+ */
+void Finder::polish(void)
+{
+    const size_t reserve{timeout / 4};
+    if ((reserve == 0) || (!isFound()))
+        return;
+
+    Assignment assignment(best.begin(), best.end());
+
+    timer.set(reserve);
+    timer.start();
+
+    size_t latest{score};
+    if (improveAssignment(tracks, sideCount, duration, goal, timer, latest, assignment))
+        seed(assignment);
+
+    timer.terminate();
+}
+
+bool Finder::addTracksToSides(void)
+{
+    // Hold back a quarter of the time to polish the result if the search is
+    // cut short.
+    timer.set(timeout - timeout / 4);
+    timer.start();
+
+    table.allocate(memory << 20);
+
+    if (!resumed)
+        frontier = split();
+
+    // Search in epochs, saving a checkpoint at the end of each one.
+    if (!checkpoint.empty())
+    {
+        std::signal(SIGTERM, interrupt);
+        std::signal(SIGINT, interrupt);
+    }
+
+    while (!frontier.empty())
+    {
+        deal(frontier);
+        if (!checkpoint.empty())
+            epoch.start();
+
+        std::vector<std::thread> threads{};
+        for (size_t id = 1; id < jobs; ++id)
+            threads.emplace_back(&Finder::work, this, id);
+
+        work(0);
+
+        for (auto & thread : threads)
+            thread.join();
+
+        epoch.terminate();
+        gather();
+
+        // The goal is only reached once no earlier task is left to search.
+        const auto & leading{getLeading()};
+        const bool reached{(leading.score <= goal) && ((frontier.empty()) || (frontier.front().order + 1 >= leading.rank))};
+        if ((!timer.isWorking()) || (reached) || (interrupted.load(std::memory_order_relaxed)))
+            break;
+
+        save();
+    }
+
+    const bool expired{!timer.isWorking()};
+    timer.terminate();
+
+    // Polishing does not watch for interruptions, so save the search first
+    // and let a signal end the process as usual while polishing.
+    save();
+
+    if (!checkpoint.empty())
+    {
+        std::signal(SIGTERM, SIG_DFL);
+        std::signal(SIGINT, SIG_DFL);
+    }
+
+    // Leave the time held back for polishing if asked to terminate.
+    if ((expired) && (!interrupted.load(std::memory_order_relaxed)))
+    {
+        polish();
+        save();
+    }
+
+    success = true;
+
+    return success;
+}
+
+/**
+ * @brief Search for the best solution using the Complete Karmarkar-Karp
+ * algorithm instead of assigning tracks to sides one at a time.
+ * 
+ * @return true if successful.
+ */
+bool Finder::combineTracks(void)
+{
+    timer.set(timeout - timeout / 4);
+    timer.start();
+
+    Assignment assignment{};
+    size_t latest{score};
+    if (completeKarmarkarKarp(tracks, sideCount, duration, goal, timer, latest, assignment))
+        seed(assignment);
+
+    const bool expired{!timer.isWorking()};
+    timer.terminate();
+
+    if (expired)
+        polish();
+
+    success = true;
+
+    return success;
+}
+
+/**
+ * @brief Balance the tracks across exactly two sides without searching.
+ * 
+ * @return true if successful.
+ * @return false if there are not two sides or the tracks need too much memory.
+ */
+bool Finder::partitionTracks(void)
+{
+    if (sideCount != 2)
+        return false;
+
+    Assignment assignment{};
+    if (!balanceTwoSides(tracks, duration, assignment))
+        return false;
+
+    if (!assignment.empty())
+        seed(assignment);
+
+    success = true;
+
+    return success;
+}
+
 
 /**
- * @section Define SideRef class.
+ * @section Implement Worker class.
  *
  */
 
-class SideRef
+template<size_t N>
+Worker<N>::Worker(Finder & owner) :
+    Searcher{owner.trackCount}, finder{owner}, loads{}, indexers{}, placement(owner.trackCount), stack{}, seen{}, latest{}, order{}, sum{}, squares{}, hash{}
 {
-public:
-    SideRef(const std::vector<Track> & trackList) : seconds{}, tracks{trackList} {}
+    // The generic search keeps the starting Indexer of each track instead.
+    if constexpr (N == 0)
+    {
+        loads.resize(finder.sideCount);
 
-    void push(size_t);
-    void pop();
+        indexers.reserve(finder.trackCount);
+        for (int track = 0; track < (int)finder.trackCount; ++track)
+            indexers.emplace_back(track, getCount());
 
-    size_t getValue() const { return seconds; }
+        // The lengths tried down the stack are lengths each side has had on
+        // the way down, and each track placed changes one side, so there are
+        // no more of them than sides and tracks together. The log of lengths
+        // tried starts at the same size.
+        if (getCount() > scan)
+        {
+            latest.reserve(finder.sideCount + finder.trackCount);
+            seen.reserve(finder.sideCount + finder.trackCount);
+        }
+    }
 
-    size_t size(void) const { return trackRefs.size(); }
-    void clear() { seconds = 0; trackRefs.clear(); }
+    stack.reserve(finder.trackCount);
+    unload();
+}
 
-    std::vector<size_t> getRefs() const { return trackRefs; }
+/**
+ * @brief Get the number of sides, which is known at compile time unless this
+ * is the generic search.
+ * 
+ * @return int the number of sides.
+ */
+template<size_t N>
+int Worker<N>::getCount(void) const
+{
+    if constexpr (N == 0)
+        return finder.sideCount;
+    else
+        return N;
+}
 
-private:
-    size_t seconds;
-    const std::vector<Track> & tracks;
-    std::vector<size_t> trackRefs;
+/**
+ * @brief Get the side to visit for a track after a number of sides have been
+ * tried.
+ * 
+ * @param trackIndex index of the track being placed.
+ * @param count number of sides already tried for this track.
+ * @return int the index of the side.
+ */
+template<size_t N>
+int Worker<N>::getSide(int trackIndex, int count) const
+{
+    if constexpr (N == 0)
+        return indexers[trackIndex].at(count);
+    else
+        return orders[trackIndex % (2 * N)][count];
+}
 
-};
+template<size_t N>
+void Worker<N>::load(const Task & task)
+{
+    order = task.order;
+    for (int track = 0; track < (int)task.prefix.size(); ++track)
+        push(task.prefix[track], track);
+}
 
-void SideRef::push(size_t track)
+template<size_t N>
+void Worker<N>::unload(void)
 {
-    trackRefs.push_back(track);
-    seconds += tracks[track].getValue();
+    std::fill(loads.begin(), loads.end(), 0);
+
+    sum = 0;
+    squares = 0;
+    hash = getCount() * Table::mix(0);
 }
 
-void SideRef::pop()
+/**
+ * @brief Add a track to a side, keeping the running sum and sum of squares of
+ * the side lengths up to date.
+ * 
+ * @param side index of the side.
+ * @param track index of the track.
+ */
+template<size_t N>
+void Worker<N>::push(int side, int track)
 {
-    seconds -= tracks[trackRefs.back()].getValue();
-    trackRefs.pop_back();
+    const size_t before{loads[side]};
+    const size_t after{before + finder.lengths[track]};
+    loads[side] = after;
+    placement[track] = side;
+
+    sum += after - before;
+    squares += after * after - before * before;
+    hash += Table::mix(after) - Table::mix(before);
 }
 
+/**
+ * @brief Remove a track from a side, keeping the running sum and sum of
+ * squares of the side lengths up to date.
+ * 
+ * @param side index of the side.
+ * @param track index of the track.
+ */
+template<size_t N>
+void Worker<N>::pop(int side, int track)
+{
+    const size_t before{loads[side]};
+    const size_t after{before - finder.lengths[track]};
+    loads[side] = after;
+
+    sum -= before - after;
+    squares -= before * before - after * after;
+    hash += Table::mix(after) - Table::mix(before);
+}
 
 /**
- * @section Define Finder class.
- *
+ * @brief Search all the assignments that start with the given task. If the
+ * search is stopped part way through, the parts not yet searched are added
+ * to the rest.
+ * 
+ * @param task to search.
+ * @param rest list of tasks not yet searched.
  */
+template<size_t N>
+void Worker<N>::run(const Task & task, std::vector<Task> & rest)
+{
+    load(task);
+    resume(task);
+    look(task.prefix.size());
+    suspend(task, rest);
+    unload();
+}
 
-class Finder
+/**
+ * @brief Turn what is left on the stack of a stopped search into a single
+ * task holding how many sides each Frame has tried. The side a Frame placed
+ * its track on is the one tried last, so the stack can be rebuilt from this.
+ * 
+ * @param task being searched.
+ * @param rest list of tasks to add to.
+ */
+template<size_t N>
+void Worker<N>::suspend(const Task & task, std::vector<Task> & rest)
 {
-public:
-    using Iterator = std::vector<SideRef>::const_iterator;
+    if (stack.empty())
+        return;
 
-    Finder(const std::vector<Track> &, const size_t, const size_t, const size_t);
+    Task next{task.order, task.prefix, {}};
+    next.tried.reserve(stack.size());
+    for (const auto & frame : stack)
+        next.tried.push_back(frame.tried);
 
-    bool addTracksToSides(void);
-    bool isSuccessful(void) const { return success; }
-    bool show(std::ostream & os) const;
-    std::string trackToString(size_t i, bool plain, bool csv) const;
-    std::string sideToString(const std::vector<size_t> &, const std::string &, bool, bool) const;
-    bool showAll(std::ostream & os, bool plain=false, bool csv=false) const;
+    rest.push_back(std::move(next));
+    stack.clear();
+    forget(0);
+}
 
-    size_t size(void) const { return sides.size(); }
-    Iterator begin(void) { return sides.begin(); }
-    Iterator end(void) { return sides.end(); }
+/**
+ * @brief Add the tasks that extend the given task by one track to the list.
+ * 
+ * @param task to extend.
+ * @param tasks list to add the extended tasks to.
+ */
+template<size_t N>
+void Worker<N>::branch(const Task & task, std::vector<Task> & tasks)
+{
+    load(task);
 
-private:
-    bool look(int track);
-    bool snapshot(double latest);
+    const int trackIndex = task.prefix.size();
+    if (isPromising(trackIndex))
+    {
+        for (int i = 0; i < getCount(); ++i)
+        {
+            const int side{getSide(trackIndex, i)};
+            if (isCandidate(trackIndex, i, side))
+            {
+                tasks.push_back(task);
+                tasks.back().prefix.push_back(side);
+            }
+        }
+        forget(0);
+    }
 
-    const size_t duration;
-    const size_t sideCount;
-    const size_t trackCount;
+    unload();
+}
 
-    bool forward;
-    int trackIndex;
-    int sideIndex;
-    bool success;
+template<size_t N>
+bool Worker<N>::snapshot(size_t latest)
+{
+    // Keep the first solution found for the earliest task.
+    if ((latest > score) || ((latest == score) && (order >= found)))
+        return false;
 
-    const std::vector<Track> & tracks;
-    std::vector<SideRef> sides;
+    score = latest;
+    found = order;
+    std::copy(placement.begin(), placement.end(), best.begin());
 
-    double dev;
-    std::vector<std::vector<size_t>> best;
-    Timer timer;
-};
+    if (finder.improve(latest, order + 1))
+        finder.publish(latest, order + 1, best);
+
+    return true;
+}
 
-Finder::Finder(const std::vector<Track> & trackList, const size_t dur, const size_t tim, const size_t count) :
-    duration{dur}, sideCount{count}, trackCount{trackList.size()},
-    forward{true}, trackIndex{}, sideIndex{}, success{}, tracks{trackList}, sides{},
-    dev{std::numeric_limits<double>::max()}, best{}, timer{tim}
+/**
+ * @brief Determine if placing the remaining tracks could produce a better
+ * solution than the best found so far. The remaining tracks must fit in the
+ * usable space left on the sides and the lowest score achievable from the
+ * current side lengths must beat the current best.
+ * 
+ * The score bound assumes the remaining time can be freely divided. Sides
+ * already longer than the mean keep their length, the rest share what is left
+ * equally.
+ * 
+ * @param trackIndex index of the next track to place.
+ * @return true if the search below this point is worth continuing.
+ * @return false otherwise.
+ */
+template<size_t N>
+bool Worker<N>::isPromising(int trackIndex) const
 {
-    sides.reserve(sideCount);
-    best.reserve(sideCount);
-    SideRef side{trackList};
-    for (int i = 0; i < sideCount; ++i)
-        sides.push_back(side);
+    const size_t sideCount = getCount();
+    const size_t total{finder.total};
+    const size_t smallest{finder.lengths[finder.trackCount-1]};
+    size_t slack{};
+    size_t above{};
+    size_t count{};
+    size_t fixed{};
+    for (const auto & seconds : loads)
+    {
+        const size_t space{finder.duration - seconds};
+        if (space >= smallest)
+            slack += space;
+
+        if (seconds * sideCount > total)
+        {
+            above += seconds;
+            fixed += seconds * seconds;
+            ++count;
+        }
+    }
+
+    // Check the remaining tracks can fit.
+    if (finder.remainder[trackIndex] > slack)
+        return false;
+
+    // Check the lowest achievable score beats the best so far.
+    const size_t rest{total - above};
+    const size_t share{sideCount - count};
+    const size_t lowest{sideCount * fixed + (sideCount * rest * rest + share - 1) / share};
+    const size_t bound{lowest - std::min(lowest, total * total)};
+
+    return bound < finder.getCutoff(order + 1);
 }
 
+/**
+ * @brief Determine if a side of the same length has already been tried for
+ * the current track. Sides of equal length are interchangeable, so placing the
+ * track on more than one of them only revisits the same partition with the
+ * sides permuted.
+ * 
+ * With more than a few dozen sides, comparing with every side tried would
+ * dominate the search, so the lengths tried by each Frame are recorded
+ * instead. The latest entry for each length is looked up, and it was tried
+ * for the current track if the entry belongs to the innermost Frame.
+ * 
+ * @param trackIndex index of the track being placed.
+ * @param count number of sides already tried for this track.
+ * @param seconds length of the side about to be tried.
+ * @return true if an equivalent side has already been tried.
+ * @return false otherwise, and the length is recorded as tried.
+ */
+template<size_t N>
+bool Worker<N>::isRepeat(int trackIndex, int count, size_t seconds)
+{
+    if constexpr (N == 0)
+    {
+        if (getCount() <= scan)
+        {
+            Indexer side{indexers[trackIndex]};
+            for (int i = 0; i < count; ++i, side.inc())
+                if (loads[side()] == seconds)
+                    return true;
+
+            return false;
+        }
+
+        const int first{stack.empty() ? 0 : stack.back().first};
+        const int index = seen.size();
+        int & entry{latest.at(seconds)};
+        if (entry >= first)
+            return true;
+
+        seen.push_back(Tried{seconds, entry});
+        entry = index;
+    }
+    else
+    {
+        const auto & sides{orders[trackIndex % (2 * N)]};
+        for (int i = 0; i < count; ++i)
+            if (loads[sides[i]] == seconds)
+                return true;
+    }
+
+    return false;
+}
 
-bool Finder::snapshot(double latest)
+/**
+ * @brief Determine if the track should be placed on the given side.
+ * 
+ * @param trackIndex index of the track being placed.
+ * @param count number of sides already tried for this track.
+ * @param side index of the side about to be tried.
+ * @return true if the track fits and the side is not a repeat.
+ * @return false otherwise.
+ */
+template<size_t N>
+bool Worker<N>::isCandidate(int trackIndex, int count, int side)
 {
-    dev = latest;
-    best.clear();
-    for (const auto & side : sides)
-        best.push_back(side.getRefs());
+    const size_t seconds{loads[side]};
+    if (isRepeat(trackIndex, count, seconds))
+        return false;
 
-    return true;
+    return seconds + finder.lengths[trackIndex] <= finder.duration;
 }
 
-bool Finder::look(int trackIndex)
+/**
+ * @brief Forget the side lengths tried by the Frames from the given entry on,
+ * restoring the latest entry for each length to the one before.
+ * 
+ * @param first entry of the first Frame to forget.
+ */
+template<size_t N>
+void Worker<N>::forget(int first)
 {
-    if ((!timer.isWorking()) || (dev < 20.0))
-        return true;
+    while ((int)seen.size() > first)
+    {
+        const Tried & entry{seen.back()};
+        if (entry.previous < 0)
+            latest.erase(entry.seconds);
+        else
+            latest.at(entry.seconds) = entry.previous;
+
+        seen.pop_back();
+    }
+}
 
-    if (trackIndex == trackCount)
+/**
+ * @brief Move down to the given track. A complete assignment is scored, while
+ * a partial one that is worth searching gets a Frame on the stack.
+ * 
+ * @param trackIndex index of the next track to place.
+ */
+template<size_t N>
+void Worker<N>::descend(int trackIndex)
+{
+    if (trackIndex == (int)finder.trackCount)
     {
-        const auto latest{deviation<SideRef>(sides)};
-        if (latest < dev)
+        const size_t latest{getCount() * squares - sum * sum};
+        if (latest < finder.getCutoff(order + 1))
             snapshot(latest);
 
-        return true;
+        return;
     }
 
-    Indexer side{trackIndex, (int)sideCount};
-    for (int i = 0; i < sideCount; ++i, side.inc())
+    if (!isPromising(trackIndex))
+        return;
+
+    // Skip the search if an equivalent one has already been done.
+    const uint64_t key{hash + Table::mix(~(uint64_t)trackIndex)};
+    ++probes;
+    if (finder.table.isRefuted(key, finder.getCutoff(order + 1)))
     {
-        auto & trackRef{tracks[trackIndex]};
-        auto & sideRef{sides[side()]};
-        if (sideRef.getValue() + trackRef.getValue() <= duration)
-        {
-            sideRef.push(trackIndex);
-            look(trackIndex+1);
-            sideRef.pop();
-        }
+        ++hits;
+        return;
     }
 
-    return false;
+    stack.push_back(Frame{0, -1, (int)seen.size(), key});
 }
 
-bool Finder::addTracksToSides(void)
+/**
+ * @brief Set up the stack to start the search of the given task, or rebuild
+ * it as it was when the task was stopped.
+ * 
+ * @param task to search.
+ */
+template<size_t N>
+void Worker<N>::resume(const Task & task)
 {
-    timer.start();
+    const int base = task.prefix.size();
 
-    success = look(0);
-    success = true;
+    stack.clear();
+    if (task.tried.empty())
+    {
+        descend(base);
 
-    timer.terminate();
+        return;
+    }
 
-    return success;
+    for (int depth = 0; depth < (int)task.tried.size(); ++depth)
+    {
+        const int trackIndex = base + depth;
+        const int tried = task.tried[depth];
+        const int placed = tried ? getSide(trackIndex, tried - 1) : -1;
+
+        stack.push_back(Frame{tried, placed, (int)seen.size(), hash + Table::mix(~(uint64_t)trackIndex)});
+
+        // Record the lengths of the sides already tried.
+        for (int count = 0; count < tried; ++count)
+            isRepeat(trackIndex, count, loads[getSide(trackIndex, count)]);
+
+        if (placed >= 0)
+            push(placed, trackIndex);
+    }
+}
+
+/**
+ * @brief Search all the assignments of the tracks from the given index
+ * onwards, using the stack instead of recursion.
+ * 
+ * @param base index of the first track to place.
+ */
+template<size_t N>
+void Worker<N>::look(int base)
+{
+    const int sideCount = getCount();
+
+    while ((!stack.empty()) && (!finder.isStopped(order + 1)))
+    {
+        const int trackIndex = base + stack.size() - 1;
+        Frame & frame{stack.back()};
+
+        // Take the track off the side it was last tried on.
+        if (frame.placed >= 0)
+        {
+            pop(frame.placed, trackIndex);
+            frame.placed = -1;
+        }
+
+        int side{};
+        while ((frame.tried < sideCount) && (!isCandidate(trackIndex, frame.tried, side = getSide(trackIndex, frame.tried))))
+            ++frame.tried;
+
+        if (frame.tried == sideCount)
+        {
+            // If the search was completed, none of its solutions beat the best now.
+            if (!finder.isStopped(order + 1))
+                finder.table.store(frame.key, finder.getIncumbent());
+
+            forget(frame.first);
+            stack.pop_back();
+            continue;
+        }
+
+        frame.placed = side;
+        ++frame.tried;
+
+        push(frame.placed, trackIndex);
+        descend(trackIndex + 1);
+    }
 }
 
 bool Finder::show(std::ostream & os) const
 {
     os << "deviation " << dev << "\n";
-    int i = 0;
-    for (const auto & side : best)
+    if (probes)
+        os << "table hits " << hits << " of " << probes << " probes (" << 100.0 * hits / probes << "%)\n";
+
+    if (!isFound())
+        return success;
+
+    for (const auto & side : getSides(best))
+        os << side.getTitle() << " - " << side.size() << " tracks " << secondsToTimeString(side.getValue()) << "\n";
+
+    return success;
+}
+
+/**
+ * @brief Generate the sides from the side of each track. The tracks are
+ * counted on each side, then ordered side by side with a single pass.
+ * 
+ * @param placement side of each track.
+ * @return Sides the tracks on each side.
+ */
+Sides Finder::getSides(const Placement & placement) const
+{
+    std::vector<size_t> breaks(sideCount + 1);
+    for (size_t track = 0; track < trackCount; ++track)
+        ++breaks[placement[track] + 1];
+    std::partial_sum(breaks.begin(), breaks.end(), breaks.begin());
+
+    std::vector<size_t> next(breaks.begin(), breaks.end() - 1);
+    std::vector<size_t> order(trackCount);
+    for (size_t track = 0; track < trackCount; ++track)
+        order[next[placement[track]]++] = track;
+
+    return Sides{tracks, std::move(order), breaks};
+}
+
+bool Finder::showAll(std::ostream & os, bool plain, bool csv) const
+{
+    if (!isFound())
+        return success;
+
+    for (const auto & side : getSides(best))
     {
-        size_t total{};
-        for (const auto & track : side)
-            total += tracks[track].getValue();
-        os << "Side " << std::to_string(++i) << " - " << side.size() << " tracks " << secondsToTimeString(total) << "\n";
+        os << side.toString(plain, csv);
+        if (!csv)
+            os << '\n';
     }
 
     return success;
 }
 
-std::string Finder::trackToString(size_t track, bool plain, bool csv) const
+
+/**
+ * @brief Read the number of sides the checkpoint file was written for.
+ * 
+ * @param checkpoint file to read.
+ * @return size_t the number of sides, or 0 if the file cannot be read.
+ */
+static size_t getCheckpointSides(const std::filesystem::path & checkpoint)
 {
-    const size_t seconds{tracks[track].getValue()};
-    std::string time{plain ? std::to_string(seconds) : secondsToTimeString(seconds)};
+    std::ifstream file{checkpoint};
+    std::string name{};
+    std::string word{};
+    uint64_t print{};
+    size_t sides{};
 
-    const std::string title{tracks[track].getTitle()};
-    const std::string c{Configuration::getDelimiter()};
-    std::string s{};
-    if (csv)
-        s = "Track" + c + time + c + "\"" + title + "\"";
-    else
-        s = time + " - " + title;
+    file >> name >> word >> word >> print >> word >> sides;
 
-    return s;
+    return ((file) && (name == "TrackSort") && (word == "sides")) ? sides : 0;
 }
 
-std::string Finder::sideToString(const std::vector<size_t> & side, const std::string & title, bool plain, bool csv) const
+/**
+ * @brief Shuffle the tracks across the given number of sides and show the
+ * result. If no sides are found and more sides may still be tried, nothing is
+ * shown.
+ * 
+ * @param tracks to shuffle, longest first.
+ * @param duration maximum length of a side.
+ * @param count number of sides.
+ * @param timeout in milliseconds.
+ * @param packing known to fit on no more than 'count' sides, or empty.
+ * @param last true if no more sides will be tried.
+ * @param restore true to carry on from the checkpoint file.
+ * @param begin time the run started, which streamed results are timed from.
+ * @return int error value, 0 if the sides were shown or -1 to try more sides.
+ */
+static int shuffleTracks(const std::vector<Track> & tracks, size_t duration, size_t count, size_t timeout, const Assignment & packing, bool last, bool restore,
+    std::chrono::steady_clock::time_point begin)
 {
-    size_t seconds{};
-    for (const auto & track : side)
-        seconds += tracks[track].getValue();
+    const auto showDebug{Configuration::isDebug()};
+    const size_t jobs{Configuration::getThreads()};     // Get user requested number of threads.
+    const size_t memory{Configuration::getMemory()};    // Get user requested table size.
+
+    if (showDebug)
+    {
+        std::cout << "\nNumber of sides " << count << "\n";
+        std::cout << "Timeout " << millisecondsToTimeString(timeout) << "\n";
+    }
 
-    std::string time{plain ? std::to_string(seconds) : secondsToTimeString(seconds)};
+    Finder find{tracks, duration, timeout, count, jobs, memory};
+    find.setGoal(Configuration::getTarget(), Configuration::getGap());
+    find.setCheckpoint(Configuration::getCheckpoint());
+    if (Configuration::isStream())
+        find.enableStream(begin);
+    if (showDebug)
+        std::cout << "Lowest possible deviation " << find.getLowest() << "\n";
 
-    const std::string c{Configuration::getDelimiter()};
-    std::string s{};
-    if (csv)
-        s = "Side" + c + time + c + "\"" + title + ", " + std::to_string(side.size()) + " tracks\"";
+    if (find.partitionTracks())
+    {
+        if (showDebug)
+            std::cout << "Two sides balanced exactly\n";
+    }
     else
-        s = title + " - " + std::to_string(side.size()) + " tracks";
-    s += '\n';
+    {
+        if ((find.seed(karmarkarKarp(tracks, count))) && (showDebug))
+        {
+            std::cout << "Karmarkar-Karp sides\n";
+            find.show(std::cout);
+        }
 
-    for (const auto & track : side)
-        s += trackToString(track, plain, csv) + "\n";
+        if ((!packing.empty()) && (find.seed(packing)) && (showDebug))
+        {
+            std::cout << "Bin packing sides\n";
+            find.show(std::cout);
+        }
 
-    if (!csv)
-        s += time + "\n\n";
+        if ((restore) && (!find.restore()))
+            return 1;
 
-    return s;
-}
+        if (Configuration::getEngine() == "ckk")
+            find.combineTracks();
+        else
+            find.addTracksToSides();
+    }
 
-bool Finder::showAll(std::ostream & os, bool plain, bool csv) const
-{
-    size_t index{};
-    for (const auto & side : best)
+    if ((!last) && (!find.isFound()))
     {
-        const std::string title{"Side " + std::to_string(++index)};
-        os << sideToString(side, title, plain, csv);
+        if (showDebug)
+            std::cout << "No sides found\n";
+
+        return -1;
     }
 
-    return success;
-}
+    if ((find.isSuccessful()) && (!Configuration::isStream()))
+    {
+        if (showDebug)
+        {
+            std::cout << "Packed sides\n";
+            find.show(std::cout);
+        }
+
+        const auto csv{Configuration::isCSV()};
+        if (!csv)
+            std::cout << "\nThe recommended sides are\n";
+
+        find.showAll(std::cout, Configuration::isPlain(), csv);
+    }
 
+    return 0;
+}
 
 int shuffleTracksAcrossSides(std::vector<Track> & tracks)
 {
     const auto showDebug{Configuration::isDebug()};
+    const auto begin{std::chrono::steady_clock::now()};
 
     // Sort track list, longest to shortest.
     auto comp = [](const Track & a, const Track & b) { return a.getValue() > b.getValue(); };
@@ -320,58 +1940,110 @@ int shuffleTracksAcrossSides(std::vector<Track> & tracks)
 
     // Calculate total play time.
     auto lambda = [](size_t a, const Track & b) { return a + b.getValue(); };
-    size_t total = std::accumulate(tracks.begin(), tracks.end(), 0, lambda);
+    size_t total = std::accumulate(tracks.begin(), tracks.end(), size_t{0}, lambda);
 
     const size_t timeout{Configuration::getTimeout()};  // Get user requested timeout.
     size_t duration{Configuration::getDuration()};      // Get user requested maximum side length.
     const size_t boxes{Configuration::getBoxes()};      // Get user requested number of sides (boxes).
+    const size_t step{Configuration::isEven() ? 2UL : 1UL};
 
-    size_t optimum{};   // The number of sides required.
-    size_t length{};    // The minimum side length.
+    size_t lower{};     // The fewest sides that could be enough.
+    size_t upper{};     // The number of sides known to be enough.
+    Assignment packing{};
 
     if (duration)
     {
-        // Calculate number of sides required.
-        optimum = total / duration;
-        if (total % duration)
-            optimum++;
-        if ((optimum & 1) && (Configuration::isEven()))
-            optimum++;
+        if (tracks[0].getValue() > duration)
+        {
+            std::cerr << "\nTrack " << tracks[0].getTitle() << " is longer than a side.\n";
+
+            return 1;
+        }
+
+        // Find the range of the number of sides required, then the fewest
+        // sides by bin completion, leaving most of the time for balancing
+        // them.
+        Timer timer{timeout / 4};
+        timer.start();
+
+        const size_t l1{lowerBoundL1(tracks, duration)};
+        const size_t l2{lowerBoundL2(tracks, duration)};
+        const size_t l3{lowerBoundL3(tracks, duration, timer)};
+        upper = firstFitDecreasing(tracks, duration, packing);
+        lower = std::max({l1, l2, l3});
+
+        if (showDebug)
+        {
+            std::cout << "Lower bounds L1 " << l1 << ", L2 " << l2 << ", L3 " << l3 << "\n";
+            std::cout << "First fit decreasing sides " << upper << "\n";
+        }
+
+        if (lower < upper)
+        {
+            const bool exact{completeBins(tracks, duration, timer, lower, upper, packing)};
+
+            if (showDebug)
+                std::cout << "Bin completion sides " << lower << " to " << upper << (exact ? ", fewest found" : ", timed out") << "\n";
+        }
+        timer.terminate();
 
-        length = total / optimum;       // Calculate minimum side length.
+        if ((lower & 1) && (Configuration::isEven()))
+            lower++;
+        if ((upper & 1) && (Configuration::isEven()))
+            upper++;
+        upper = std::max(lower, upper);
     }
     else
     {
-        optimum = boxes;
-        length = total / optimum;       // Calculate minimum side length.
+        lower = upper = boxes;
 
-        duration = length + (*tracks.begin()).getValue();
+        duration = total / boxes + (*tracks.begin()).getValue();
     }
 
     if (showDebug)
     {
         std::cout << "Total duration " << secondsToTimeString(total) << "\n";
         std::cout << "Required duration " << secondsToTimeString(duration) << "\n";
-        std::cout << "Required timeout " << secondsToTimeString(timeout) << "\n";
-        std::cout << "Optimum number of sides " << optimum << "\n";
-        std::cout << "Minimum side length " << secondsToTimeString(length) << "\n";
+        std::cout << "Required timeout " << millisecondsToTimeString(timeout) << "\n";
+        std::cout << "Required jobs " << Configuration::getJobs() << ", using " << Configuration::getThreads() << "\n";
+        std::cout << "Required engine " << Configuration::getEngine() << "\n";
+        std::cout << "Required table size " << Configuration::getMemory() << "MB\n";
+        std::cout << "Load kernel " << getLoadKernel() << "\n";
+        std::cout << "Optimum number of sides " << lower << "\n";
+        std::cout << "Minimum side length " << secondsToTimeString(total / lower) << "\n";
     }
 
-    Finder find{tracks, duration, timeout, optimum};
-    find.addTracksToSides();
-    if (find.isSuccessful())
+    // When resuming, the numbers of sides before the one the checkpoint was
+    // written for have already been tried. The first number tried carries on
+    // from the checkpoint, which is rejected if it is for another number.
+    bool resume{Configuration::isResume()};
+    const size_t resumed{resume ? getCheckpointSides(Configuration::getCheckpoint()) : 0};
+
+    // Try each number of sides in turn, giving each but the last half the
+    // time left.
+    for (size_t count = lower; ; count += step)
     {
-        if (showDebug)
-        {
-            std::cout << "Packed sides\n";
-            find.show(std::cout);
-        }
+        const bool last{count >= upper};
+        if ((count < resumed) && (!last))
+            continue;
 
-        const auto csv{Configuration::isCSV()};
-        if (!csv)
-            std::cout << "\nThe recommended sides are\n";
+        const size_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+        const size_t remaining{timeout > elapsed ? timeout - elapsed : 0};
 
-        find.showAll(std::cout, Configuration::isPlain(), csv);
+        const int result{shuffleTracks(tracks, duration, count, last ? remaining : remaining / 2, count >= upper ? packing : Assignment{}, last, resume, begin)};
+        if (result >= 0)
+            return result;
+
+        resume = false;
+
+        // Stop here, so the checkpoint left is for the number of sides that
+        // was interrupted.
+        if (interrupted.load(std::memory_order_relaxed))
+        {
+            std::cerr << "\nInterrupted while trying " << count << " sides.\n";
+
+            return 1;
+        }
     }
 
     return 0;
@@ -53,16 +53,41 @@ Track::Track(std::string line)
     title = line.substr(pos);
 }
 
-std::string Track::toString(bool plain, bool csv) const
+/**
+ * @brief Append the track to the given string, without building any
+ * intermediate strings.
+ * 
+ * @param s string to append to.
+ * @param plain if true show the length in seconds, otherwise as hh:mm:ss.
+ * @param csv if true generate comma separated values.
+ */
+void Track::append(std::string & s, bool plain, bool csv) const
 {
-    std::string time{plain ? std::to_string(seconds) : secondsToTimeString(seconds)};
+    const std::string time{plain ? std::to_string(seconds) : secondsToTimeString(seconds)};
 
-    const std::string c{Configuration::getDelimiter()};
-    std::string s{};
     if (csv)
-        s = "Track" + c + time + c + "\"" + title + "\"";
+    {
+        const char c{Configuration::getDelimiter()};
+        s += "Track";
+        s += c;
+        s += time;
+        s += c;
+        s += '"';
+        s += title;
+        s += '"';
+    }
     else
-        s = time + " - " + title;
+    {
+        s += time;
+        s += " - ";
+        s += title;
+    }
+}
+
+std::string Track::toString(bool plain, bool csv) const
+{
+    std::string s{};
+    append(s, plain, csv);
 
     return s;
 }
@@ -73,36 +98,115 @@ std::string Track::toString(bool plain, bool csv) const
  *
  */
 
-void Side::push(const Track & track)
-{
-    tracks.push_back(track);
-    seconds += track.getValue();
-}
-
-void Side::pop()
+Side::Side(const std::vector<Track> & list, std::span<const size_t> trackIndices, size_t index) :
+    tracks{&list}, indices{trackIndices}, number{index}, seconds{}
 {
-    seconds -= tracks.back().getValue();
-    tracks.pop_back();
+    for (const auto & track : *this)
+        seconds += track.getValue();
 }
 
 std::string Side::toString(bool plain, bool csv) const
 {
-    std::string time{plain ? std::to_string(seconds) : secondsToTimeString(seconds)};
+    const std::string time{plain ? std::to_string(seconds) : secondsToTimeString(seconds)};
+    const std::string count{std::to_string(size())};
 
-    const std::string c{Configuration::getDelimiter()};
     std::string s{};
+    s.reserve(64 * (size() + 2));
     if (csv)
-        s = "Side" + c + time + c + "\"" + title + ", " + std::to_string(size()) + " tracks\"";
+    {
+        const char c{Configuration::getDelimiter()};
+        s += "Side";
+        s += c;
+        s += time;
+        s += c;
+        s += '"';
+        s += getTitle();
+        s += ", ";
+        s += count;
+        s += " tracks\"";
+    }
     else
-        s = title + " - " + std::to_string(size()) + " tracks";
+    {
+        s += getTitle();
+        s += " - ";
+        s += count;
+        s += " tracks";
+    }
     s += '\n';
 
-    for (const auto & track : tracks)
-        s += track.toString(plain, csv) + "\n";
+    for (const auto & track : *this)
+    {
+        track.append(s, plain, csv);
+        s += '\n';
+    }
 
     if (!csv)
-        s += time + '\n';
+    {
+        s += time;
+        s += '\n';
+    }
 
     return s;
 }
 
+/**
+ * @brief Generate a JSON object for the side holding its length and the
+ * titles of its tracks.
+ * 
+ * @return std::string the JSON object.
+ */
+std::string Side::toJSON(void) const
+{
+    std::string s{"{\"seconds\":"};
+    s += std::to_string(seconds);
+    s += ",\"tracks\":[";
+
+    bool first{true};
+    for (const auto & track : *this)
+    {
+        if (!first)
+            s += ',';
+        first = false;
+
+        s += '"';
+        for (const auto c : track.getTitle())
+        {
+            if ((c == '"') || (c == '\\'))
+                s += '\\';
+
+            if ((unsigned char)c < 0x20)
+                s += ' ';
+            else
+                s += c;
+        }
+        s += '"';
+    }
+    s += "]}";
+
+    return s;
+}
+
+
+/**
+ * @section Define Sides class.
+ *
+ */
+
+/**
+ * @brief Construct the sides from the order of the tracks and the index in
+ * that order where each side starts.
+ * 
+ * @param list of tracks shared by all the sides.
+ * @param trackOrder indices of the tracks, side by side.
+ * @param breaks index in the order of the first track of each side, then
+ * the number of tracks.
+ */
+Sides::Sides(const std::vector<Track> & list, std::vector<size_t> trackOrder, const std::vector<size_t> & breaks) :
+    order{std::move(trackOrder)}, sides{}
+{
+    const std::span<const size_t> all{order};
+
+    sides.reserve(breaks.size() - 1);
+    for (size_t i = 0; i + 1 < breaks.size(); ++i)
+        sides.emplace_back(list, all.subspan(breaks[i], breaks[i+1] - breaks[i]), i + 1);
+}
@@ -29,6 +29,7 @@
 
 #include <string>
 #include <vector>
+#include <span>
 
 
 /**
@@ -44,6 +45,7 @@ public:
     std::string getTitle() const { return title; }
     size_t getValue() const { return seconds; }
 
+    void append(std::string & s, bool plain=false, bool csv=false) const;
     std::string toString(bool plain=false, bool csv=false) const;
 
 private:
@@ -55,34 +57,76 @@ private:
 /**
  * @section Define Side class.
  *
+ * A Side is a view of some of the tracks in a shared track list, holding only
+ * the indices of its tracks, so no Track is copied.
  */
 
 class Side
 {
 public:
-    using Iterator = std::vector<Track>::const_iterator;
+    class Iterator
+    {
+    public:
+        Iterator(const std::vector<Track> & list, const size_t * index) : tracks{&list}, at{index} {}
 
-    Side() : title{}, seconds{} {}
+        const Track & operator*() const { return (*tracks)[*at]; }
+        Iterator & operator++() { ++at; return *this; }
+        bool operator!=(const Iterator & other) const { return at != other.at; }
 
-    void setTitle(const std::string & t) { title = t; }
-    void push(const Track & track);
-    void pop();
+    private:
+        const std::vector<Track> * tracks;
+        const size_t * at;
+    };
 
-    std::string getTitle() const { return title; }
+    Side(const std::vector<Track> & list, std::span<const size_t> indices, size_t number);
+
+    std::string getTitle() const { return "Side " + std::to_string(number); }
     size_t getValue() const { return seconds; }
 
-    size_t size(void) const { return tracks.size(); }
-    Iterator begin(void) { return tracks.begin(); }
-    Iterator end(void) { return tracks.end(); }
+    size_t size(void) const { return indices.size(); }
+    Iterator begin(void) const { return Iterator{*tracks, indices.data()}; }
+    Iterator end(void) const { return Iterator{*tracks, indices.data() + indices.size()}; }
 
     std::string toString(bool plain=false, bool csv=false) const;
-
-    void clear() { seconds = 0; tracks.clear(); }
+    std::string toJSON(void) const;
 
 private:
-    std::string title;
+    const std::vector<Track> * tracks;
+    std::span<const size_t> indices;
+    size_t number;
     size_t seconds;
-    std::vector<Track> tracks;
+
+};
+
+
+/**
+ * @section Define Sides class.
+ *
+ * Sides holds the order of the tracks across all the sides, with each Side a
+ * view of a run of that order. It can be moved, which leaves the views valid,
+ * but not copied.
+ */
+
+class Sides
+{
+public:
+    using Iterator = std::vector<Side>::const_iterator;
+
+    Sides(const std::vector<Track> & list, std::vector<size_t> order, const std::vector<size_t> & breaks);
+
+    Sides(const Sides &) = delete;
+    Sides & operator=(const Sides &) = delete;
+    Sides(Sides &&) = default;
+    Sides & operator=(Sides &&) = default;
+
+    size_t size(void) const { return sides.size(); }
+    const Side & operator[](size_t i) const { return sides[i]; }
+    Iterator begin(void) const { return sides.begin(); }
+    Iterator end(void) const { return sides.end(); }
+
+private:
+    std::vector<size_t> order;
+    std::vector<Side> sides;
 
 };
 
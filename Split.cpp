@@ -28,218 +28,615 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <thread>
 
 #include "Side.h"
 #include "Utilities.h"
 #include "Configuration.h"
 
 /**
- * @brief Splits a list of tracks across multiple sides using the upper side
- * length limit of 'duration'.
+ * @section Define Partitioner class.
+ *
+ * Partitioner splits the tracks, in order, across a given number of sides
+ * with the lowest possible sum of the squares of the side lengths, which
+ * gives the lowest deviation. No side may be longer than 'duration'.
+ * 
+ * The cost of a side is the square of its length, and these costs satisfy
+ * the quadrangle inequality, so the best number of sides given a penalty for
+ * each side is found in O(n log n) time using the last track of each side
+ * in order, as the best place to start the side holding a track never moves
+ * back. The lowest total cost is convex in the number of sides, so the
+ * penalty that makes the required number of sides best is found by binary
+ * search. When several numbers of sides are equally good, the partitions with
+ * the fewest and the most sides are combined to give the number required.
  * 
- * @param tracks to split across sides.
- * @param duration limit of a side.
- * @return std::vector<Side> list of sides containing the tracks.
+ * The running total of the track lengths is held in 'prefix', so the length
+ * of any run of tracks is found without walking through them.
+ * 
+ * Each penalty tried is a Probe with its own tables, so given several jobs
+ * the search tries several penalties at once, one on each thread, cutting the
+ * range into more parts each round. The number of sides given by each
+ * penalty tried is kept as a Trial, so splitting across another number of
+ * sides starts from a narrower range, and the tables are reused.
  */
-static std::vector<Side> addTracksToSides(const std::vector<Track> & tracks, size_t duration)
+
+class Partitioner
 {
-    // std::cout << "Add tracks to sides\n";
-    std::vector<Side> sides;
-    Side side{};
-    for (const auto & track : tracks)
+public:
+    Partitioner(const std::vector<Track> & tracks, size_t duration, size_t jobs);
+
+    size_t getFewest(void) const;
+    void getLoads(const std::vector<size_t> & breaks, std::vector<size_t> & loads) const;
+    std::vector<size_t> split(size_t count);
+
+private:
+    static constexpr size_t none{std::numeric_limits<size_t>::max()};
+
+    struct Cost
     {
-        if (side.getValue() + track.getValue() <= duration)
-        {
-            side.push(track);
-        }
-        else
-        {
-            const auto count{sides.size() + 1};
-            const std::string title{"Side " + std::to_string(count)};
-            side.setTitle(title);
-            sides.push_back(side);
-            side.clear();
-            side.push(track);
-        }
-    }
-    if (side.size() != 0)
+        size_t value;
+        size_t count;
+    };
+
+    struct Trial
+    {
+        size_t penalty;
+        size_t sides;
+    };
+
+    struct Probe
+    {
+        size_t penalty;
+        bool fewest;
+        std::vector<Cost> best;
+        std::vector<size_t> start;
+        std::vector<size_t> breaks;
+    };
+
+    size_t getLast(size_t from) const;
+    bool isBetter(const Probe & probe, const Cost & a, const Cost & b) const;
+    Cost getCost(const Probe & probe, size_t from, size_t to) const;
+    void solve(Probe & probe) const;
+    void solve(size_t count);
+
+    const size_t trackCount;
+    const size_t duration;
+    const size_t jobs;
+    std::vector<size_t> prefix;
+
+    std::vector<Probe> probes;
+    std::vector<Trial> trials;
+};
+
+Partitioner::Partitioner(const std::vector<Track> & tracks, size_t dur, size_t threads) :
+    trackCount{tracks.size()}, duration{dur}, jobs{std::max(threads, (size_t)1)},
+    prefix(tracks.size() + 1), probes(std::max(jobs, (size_t)2)), trials{}
+{
+    for (size_t i = 0; i < trackCount; ++i)
+        prefix[i+1] = prefix[i] + tracks[i].getValue();
+}
+
+/**
+ * @brief Find the end of the longest run of tracks from the given one that
+ * fits on a side. The binary search always halves the range, choosing the
+ * half with a conditional move instead of a branch.
+ * 
+ * @param from index of the first track of the side.
+ * @return size_t index of the track after the side.
+ */
+size_t Partitioner::getLast(size_t from) const
+{
+    const size_t limit{prefix[from] + duration};
+    const size_t * base{prefix.data() + from};
+    size_t size{prefix.size() - from};
+    while (size > 1)
     {
-        const auto count{sides.size() + 1};
-        const std::string title{"Side " + std::to_string(count)};
-        side.setTitle(title);
-        sides.push_back(side);
-        side.clear();
+        const size_t half{size / 2};
+        base = (base[half] <= limit) ? base + half : base;
+        size -= half;
     }
 
-    return sides;
+    return std::max((size_t)(base - prefix.data()), from + 1);
 }
 
 /**
- * @brief Determine if the minimum side length is too short by checking if the
- * current number of sides exceeds the required number of sides.
+ * @brief Count the fewest sides the tracks fit on in order, by filling each
+ * side in turn, jumping from side to side.
  * 
- * @param required number of sides.
- * @param current number of sides.
- * @return true if the current number of sides exceeds the required.
- * @return false otherwise.
+ * @return size_t the number of sides.
  */
-static bool isMinimumTooShort(size_t required, size_t current)
+size_t Partitioner::getFewest(void) const
 {
-    if (required < current)
-        return true;
+    size_t sides{};
+    for (size_t from = 0; from < trackCount; from = getLast(from))
+        ++sides;
 
-    return false;
+    return sides;
+}
+
+/**
+ * @brief Get the length of each side of a split from the running totals,
+ * without walking through the tracks.
+ * 
+ * @param breaks index of the first track of each side, then the track count.
+ * @param loads updated with the length of each side.
+ */
+void Partitioner::getLoads(const std::vector<size_t> & breaks, std::vector<size_t> & loads) const
+{
+    loads.resize(breaks.size() - 1);
+    for (size_t i = 0; i < loads.size(); ++i)
+        loads[i] = prefix[breaks[i+1]] - prefix[breaks[i]];
 }
 
 /**
- * @brief Determine if the maximum side length is too long by checking that the
- * length of the last side is close to the average length of all previous
- * sides. If it isn't, then the previous sides are too greedy.
+ * @brief Compare two costs, breaking ties by the number of sides.
  * 
- * @param sides currently being considered.
- * @return true if last side doesn't hold enough tracks.
+ * @param probe penalty being tried and how to break ties.
+ * @param a cost to compare.
+ * @param b cost to compare against.
+ * @return true if 'a' is strictly better than 'b'.
  * @return false otherwise.
  */
-static bool isMaximumTooLong(const std::vector<Side> & sides)
+bool Partitioner::isBetter(const Probe & probe, const Cost & a, const Cost & b) const
 {
-    const auto count{sides.size() - 1};
-    if (count <= 0)
-        return false;
+    if (a.value != b.value)
+        return a.value < b.value;
 
-    // Calculate the standard deviation of all side lengths.
-    if (deviation(sides) > 10.0)
-         return true;
+    return probe.fewest ? a.count < b.count : a.count > b.count;
+}
 
-    return false;
+/**
+ * @brief Get the cost of the best split of the tracks before 'to' whose last
+ * side starts with the track at 'from'.
+ * 
+ * @param probe penalty being tried and the best splits found so far.
+ * @param from index of the first track on the last side.
+ * @param to index of the track after the last side.
+ * @return Cost of the split, with a value of none if the side is too long.
+ */
+Partitioner::Cost Partitioner::getCost(const Probe & probe, size_t from, size_t to) const
+{
+    const auto & best{probe.best};
+    const size_t seconds{prefix[to] - prefix[from]};
+    if ((seconds > duration) || (best[from].value == none))
+        return Cost{none, 0};
+
+    return Cost{best[from].value + seconds * seconds + probe.penalty, best[from].count + 1};
 }
 
 /**
- * @brief Reads the track list from the user specified file and optimally
- * splits them across multiple sides so that the sides have similar lengths.
+ * @brief Find the best split of the tracks for the penalty of the probe. Each
+ * candidate place to start the last side is best for a range of tracks, and
+ * a later candidate that becomes at least as good stays so, which makes the
+ * ranges a queue. The range of a new candidate is found by binary search.
  * 
- * @return int error value of 0.
+ * @param probe penalty to try, which receives the index of the first track
+ * of each side, then the number of tracks.
  */
-int splitTracksAcrossSides(std::vector<Track> & tracks)
+void Partitioner::solve(Probe & probe) const
 {
-    const auto showDebug{Configuration::isDebug()};
+    struct Range
+    {
+        size_t from;
+        size_t first;
+    };
 
-    // Calculate total play time.
-    auto lambda = [](size_t a, const Track & b) { return a + b.getValue(); };
-    const size_t total = std::accumulate(tracks.begin(), tracks.end(), 0, lambda);
+    // Determine if 'later' is at least as good a place to start as 'earlier'.
+    auto isDominant = [this, &probe](size_t later, size_t earlier, size_t to)
+        { return !isBetter(probe, getCost(probe, earlier, to), getCost(probe, later, to)); };
 
-    const size_t timeout{Configuration::getTimeout()};  // Get user requested timeout.
-    size_t duration{Configuration::getDuration()};      // Get user requested maximum side length.
-    const size_t boxes{Configuration::getBoxes()};      // Get user requested number of sides (boxes).
+    auto & best{probe.best};
+    auto & start{probe.start};
+    best.resize(trackCount + 1);
+    start.resize(trackCount + 1);
 
-    std::vector<Side> sides{};  // The list of sides containing a list of tracks.
-    size_t optimum{};           // The number of sides required.
-    size_t length{};            // The minimum side length.
+    std::vector<Range> queue{};
+    queue.reserve(trackCount + 1);
+    queue.push_back({0, 1});
+    size_t head{};
 
-    if (duration)
+    best[0] = Cost{0, 0};
+    for (size_t to = 1; to <= trackCount; ++to)
     {
-        sides = addTracksToSides(tracks, duration); // Calculate 'packed' sides -> minimum sides needed.
+        while ((head + 1 < queue.size()) && (queue[head + 1].first <= to))
+            ++head;
 
-        // Calculate number of sides required.
-        optimum = sides.size();
-        if ((optimum & 1) && (Configuration::isEven()))
-            optimum++;
+        start[to] = queue[head].from;
+        best[to] = getCost(probe, start[to], to);
 
-        length = total / optimum;       // Calculate minimum side length.
-    }
-    else
-    {
-        optimum = boxes;
-        length = total / optimum;       // Calculate minimum side length.
+        // Remove the candidates that the new one beats for their whole range.
+        while ((queue.size() > head + 1) && (queue.back().first > to) && (isDominant(to, queue.back().from, queue.back().first)))
+            queue.pop_back();
 
-        auto comp = [](const Track & a, const Track & b) { return a.getValue() < b.getValue(); };
-        auto max = std::max_element(tracks.begin(), tracks.end(), comp);
+        // Past the longest side starting here every candidate is too long,
+        // so the new one is as good.
+        size_t low{std::max(queue.back().first, to + 1)};
+        size_t high{std::min(getLast(to), trackCount) + 1};
+        while (low < high)
+        {
+            const size_t middle{(low + high) / 2};
+            if (isDominant(to, queue.back().from, middle))
+                high = middle;
+            else
+                low = middle + 1;
+        }
 
-        duration = length + (*max).getValue();
+        if (low <= trackCount)
+            queue.push_back({to, low});
     }
 
-    if (showDebug)
-    {
-        std::cout << "Total duration " << secondsToTimeString(total) << "\n";
-        std::cout << "Required timeout " << secondsToTimeString(timeout) << "\n";
-        std::cout << "Required duration " << secondsToTimeString(duration) << "\n";
-        std::cout << "Required side count " << boxes << "\n";
-        std::cout << "Optimum number of sides " << optimum << "\n";
-        std::cout << "Minimum side length " << secondsToTimeString(length) << "\n";
-    }
+    auto & breaks{probe.breaks};
+    breaks.clear();
+    for (size_t to = trackCount; to != 0; to = start[to])
+        breaks.push_back(to);
+    breaks.push_back(0);
+    std::reverse(breaks.begin(), breaks.end());
+}
 
-    // Home in on optimum side length.
-    Timer timer{timeout};
-    size_t minimum{length};
-    size_t maximum{duration};
+/**
+ * @brief Solve the first few probes at once, each on its own thread.
+ * 
+ * @param count number of probes to solve.
+ */
+void Partitioner::solve(size_t count)
+{
+    std::vector<std::thread> threads{};
+    for (size_t i = 1; i < count; ++i)
+        threads.emplace_back([this, i]() { solve(probes[i]); });
+
+    solve(probes[0]);
 
-    timer.start();
-    while (minimum <= maximum)
+    for (auto & thread : threads)
+        thread.join();
+}
+
+/**
+ * @brief Split the tracks, in order, across the given number of sides with
+ * the lowest sum of squares of the side lengths.
+ * 
+ * @param count number of sides, which must be enough for no side to be
+ * longer than 'duration'.
+ * @return std::vector<size_t> index of the first track of each side, then
+ * the number of tracks.
+ */
+std::vector<size_t> Partitioner::split(size_t count)
+{
+    std::vector<size_t> breaks(trackCount + 1);
+    if (count >= trackCount)
     {
-        size_t median{(minimum + maximum + 1) / 2};
-        if (showDebug)
-            std::cout << "\nSuggested length " << secondsToTimeString(median) << "\n";
+        std::iota(breaks.begin(), breaks.end(), 0);
+        return breaks;
+    }
 
-        sides.clear();
-        sides = addTracksToSides(tracks, median);
+    // Find a penalty for which the fewest sides are the number required, or
+    // failing that the lowest penalty for which they are few enough. A
+    // penalty above the cost of the fewest sides, each no longer than
+    // 'duration', always gives the fewest sides possible.
+    const size_t total{prefix.back()};
+    size_t low{};
+    size_t high{std::min(duration, total) * total + 1};
 
-        if (showDebug)
+    // The number of sides is close to the total length over the square root
+    // of the penalty, so one penalty tried is interpolated from the sides
+    // found, taking turns with cutting the range evenly, or its logarithm
+    // while it is wide, so the search always narrows. With more than one job
+    // the range is also cut by the other penalties tried in the same round.
+    Trial over{none, 0};    // Highest penalty giving too many sides.
+    Trial under{none, 0};   // Lowest penalty giving too few sides.
+    auto narrow = [&](const Trial & trial)
+    {
+        if ((trial.sides < count) && (trial.penalty < high))
         {
-            std::cout << "Suggested sides\n";
-            for (const auto & side : sides)
-                std::cout << side.getTitle() << " - " << side.size() << " tracks " << secondsToTimeString(side.getValue()) << "\n";
+            high = trial.penalty;
+            under = trial;
         }
-
-        if ((median == minimum) || (median == maximum))
+        else if ((trial.sides > count) && (trial.penalty >= low))
         {
-            break;
+            low = trial.penalty + 1;
+            over = trial;
         }
-        else
-        if (isMinimumTooShort(optimum, sides.size()))
+    };
+    auto interpolate = [&]()
+    {
+        if ((over.penalty != none) && (under.penalty != none))
         {
-            minimum = median;
-            if (showDebug)
-            {
-                std::cout << "Minimum set to " << secondsToTimeString(minimum) << "\n";
-                std::cout << "Maximum is " << secondsToTimeString(maximum) << "\n";
-            }
+            const double x{1.0 / std::sqrt((double)over.penalty + 1)};
+            const double y{1.0 / std::sqrt((double)under.penalty + 1)};
+            const double z{x + (y - x) * (over.sides - count) / (over.sides - under.sides)};
+
+            return 1.0 / (z * z) - 1;
         }
-        else
-        if (isMaximumTooLong(sides))
+
+        const Trial & trial{(over.penalty != none) ? over : under};
+        const double ratio{(double)trial.sides / count};
+
+        return trial.penalty * ratio * ratio;
+    };
+
+    // Start from the penalties tried for other numbers of sides, trying
+    // first any that gave the number required.
+    const size_t length{total / count};
+    double estimate{(double)std::min(length * length, high - 1)};
+    for (const auto & trial : trials)
+        narrow(trial);
+    if ((over.penalty != none) && (under.penalty != none))
+        estimate = interpolate();
+    for (const auto & trial : trials)
+        if (trial.sides == count)
+            estimate = trial.penalty;
+
+    bool guess{true};
+    while (low < high)
+    {
+        std::vector<size_t> penalties{};
+        if ((guess) && (estimate >= low) && (estimate < high))
+            penalties.push_back(estimate);
+
+        const size_t cuts{jobs - penalties.size()};
+        for (size_t i = 1; i <= cuts; ++i)
         {
-            maximum = median;
-            if (showDebug)
-            {
-                std::cout << "Minimum is " << secondsToTimeString(minimum) << "\n";
-                std::cout << "Maximum set to " << secondsToTimeString(maximum) << "\n";
-            }
+            const double part{(double)i / (cuts + 1)};
+            if (high / 4 > low)
+                penalties.push_back(std::pow(std::max((double)low, 1.0), 1 - part) * std::pow((double)high, part));
+            else
+                penalties.push_back(low + (high - low) * part);
         }
-        else
+
+        // A penalty of nothing gives the most sides, which anchors the
+        // interpolation better than any other penalty below the range.
+        if ((low == 0) && (cuts))
+            penalties[penalties.size() - cuts] = 0;
+        std::sort(penalties.begin(), penalties.end());
+        penalties.erase(std::unique(penalties.begin(), penalties.end()), penalties.end());
+
+        for (size_t i = 0; i < penalties.size(); ++i)
         {
-            break;
+            probes[i].penalty = std::clamp(penalties[i], low, high - 1);
+            probes[i].fewest = true;
         }
+        solve(penalties.size());
 
-        if (!timer.isWorking())
+        for (size_t i = 0; i < penalties.size(); ++i)
         {
-            if (showDebug)
-                std::cout << "Abort!!!\n";
-            break;
+            auto & probe{probes[i]};
+            const Trial trial{probe.penalty, probe.breaks.size() - 1};
+            trials.push_back(trial);
+            if (trial.sides == count)
+                return std::move(probe.breaks);
+
+            narrow(trial);
         }
+
+        estimate = interpolate();
+        guess = !guess;
+        if (estimate <= low)
+            estimate = none;
     }
-    timer.terminate();
 
-    const auto csv{Configuration::isCSV()};
+    // Find the splits with the fewest and the most sides for this penalty.
+    auto & lower{probes[0]};
+    auto & upper{probes[1]};
+    lower.penalty = upper.penalty = low;
+    lower.fewest = true;
+    upper.fewest = false;
+    if (jobs > 1)
+    {
+        solve(2);
+    }
+    else
+    {
+        solve(lower);
+        if (lower.breaks.size() - 1 == count)
+            return std::move(lower.breaks);
 
-    if (csv)
+        solve(upper);
+    }
+    if (lower.breaks.size() - 1 == count)
+        return std::move(lower.breaks);
+
+    // Both splits are best for this penalty, so replacing a side of the one
+    // with fewer sides by the sides of the other that fall within it gives
+    // a split that is also best, with exactly the number of sides required.
+    const auto & first{lower.breaks};
+    const auto & second{upper.breaks};
+    const size_t extra{count - (first.size() - 1)};
+    for (size_t i = 0; i + 1 < first.size(); ++i)
+    {
+        const size_t j{i + extra};
+        if ((first[i] <= second[j]) && (second[j+1] <= first[i+1]))
+        {
+            breaks.assign(second.begin(), second.begin() + j + 1);
+            breaks.insert(breaks.end(), first.begin() + i + 1, first.end());
+
+            return breaks;
+        }
+    }
+
+    return std::move(lower.breaks);
+}
+
+/**
+ * @brief Display the given sides, listing the tracks on each.
+ * 
+ * @param sides to display.
+ * @param title shown before the sides unless generating csv.
+ */
+static void showSides(const Sides & sides, const std::string & title)
+{
+    if (Configuration::isCSV())
     {
         for (const auto & side : sides)
             std::cout << side.toString(Configuration::isPlain(), true);
     }
     else
     {
-        std::cout << "\nThe recommended sides are\n";
+        std::cout << "\n" << title << "\n";
         for (const auto & side : sides)
             std::cout << side.toString(Configuration::isPlain(), false) << "\n";
     }
+}
+
+/**
+ * @brief Split the tracks, in order, across each number of sides in the user
+ * specified range, then compare the splits. Every split reuses the running
+ * totals, the tables and the penalties tried by the splits before it.
+ * 
+ * @param tracks list to split.
+ * @param partitioner used for every split.
+ * @return int error value or 0 if no errors.
+ */
+static int splitTracksAcrossRange(const std::vector<Track> & tracks, Partitioner & partitioner)
+{
+    const auto showDebug{Configuration::isDebug()};
+    const auto plain{Configuration::isPlain()};
+    const auto csv{Configuration::isCSV()};
+    const auto even{Configuration::isEven()};
+
+    // Use no fewer sides than the tracks fit on, and no more than tracks.
+    const size_t fewest{partitioner.getFewest()};
+    size_t first{std::max(Configuration::getMinimum(), fewest)};
+    const size_t last{std::min(Configuration::getMaximum(), tracks.size())};
+    if ((first & 1) && (even))
+        first++;
+
+    if (showDebug)
+    {
+        std::cout << "Fewest sides " << fewest << "\n";
+        std::cout << "Side counts " << first << " to " << last << "\n";
+    }
+
+    if (first > last)
+    {
+        std::cerr << "\nNo number of sides from " << Configuration::getMinimum() << " to " << Configuration::getMaximum();
+        std::cerr << " suits the tracks, which fit on " << (even ? "an even number of " : "") << "sides from " << fewest << " to " << tracks.size() << ".\n";
+
+        return 1;
+    }
+
+    struct Result
+    {
+        size_t count;
+        size_t longest;
+        double deviation;
+    };
+    std::vector<Result> results{};
+
+    // Each split is scored from the side lengths alone, held in one array.
+    std::vector<size_t> order(tracks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<size_t> loads{};
+    for (size_t count = first; count <= last; count += even ? 2 : 1)
+    {
+        const auto breaks{partitioner.split(count)};
+        partitioner.getLoads(breaks, loads);
+        const Result result{count, *std::max_element(loads.begin(), loads.end()), deviation(loads)};
+        results.push_back(result);
+
+        if (csv)
+        {
+            const char c{Configuration::getDelimiter()};
+            std::cout << "Split" << c << count << c << result.deviation << "\n";
+        }
+        const Sides sides{tracks, order, breaks};
+        showSides(sides, "The recommended " + std::to_string(count) + " sides are");
+    }
+
+    if (!csv)
+    {
+        std::cout << "\nThe splits across each number of sides are\n";
+        for (const auto & result : results)
+        {
+            const std::string time{plain ? std::to_string(result.longest) : secondsToTimeString(result.longest)};
+            std::cout << result.count << " sides - longest " << time << " - deviation " << result.deviation << "\n";
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Reads the track list from the user specified file and optimally
+ * splits them across multiple sides so that the sides have similar lengths.
+ * 
+ * @return int error value of 0.
+ */
+int splitTracksAcrossSides(std::vector<Track> & tracks)
+{
+    const auto showDebug{Configuration::isDebug()};
+
+    // Calculate total play time.
+    auto lambda = [](size_t a, const Track & b) { return a + b.getValue(); };
+    const size_t total = std::accumulate(tracks.begin(), tracks.end(), size_t{0}, lambda);
+
+    size_t duration{Configuration::getDuration()};      // Get user requested maximum side length.
+    const size_t boxes{Configuration::getBoxes()};      // Get user requested number of sides (boxes).
+
+    size_t optimum{};           // The number of sides required.
+    size_t length{};            // The minimum side length.
+
+    auto comp = [](const Track & a, const Track & b) { return a.getValue() < b.getValue(); };
+    const auto longest{std::max_element(tracks.begin(), tracks.end(), comp)};
+
+    if (duration)
+    {
+        if ((longest != tracks.end()) && ((*longest).getValue() > duration))
+        {
+            std::cerr << "\nTrack " << (*longest).getTitle() << " is longer than a side.\n";
+
+            return 1;
+        }
+    }
+    else
+    {
+        duration = total;               // Any side length will do.
+    }
+
+    Partitioner partitioner{tracks, duration, Configuration::getThreads()};
+
+    if (Configuration::isRange())
+        return splitTracksAcrossRange(tracks, partitioner);
+
+    if (boxes)
+    {
+        optimum = boxes;
+    }
+    else
+    {
+        // Calculate number of sides required.
+        optimum = partitioner.getFewest();
+        if ((optimum & 1) && (Configuration::isEven()))
+            optimum++;
+    }
+
+    if (optimum)
+        length = total / optimum;       // Calculate minimum side length.
+
+    if (showDebug)
+    {
+        std::cout << "Total duration " << secondsToTimeString(total) << "\n";
+        std::cout << "Required duration " << secondsToTimeString(duration) << "\n";
+        std::cout << "Required side count " << boxes << "\n";
+        std::cout << "Optimum number of sides " << optimum << "\n";
+        std::cout << "Minimum side length " << secondsToTimeString(length) << "\n";
+    }
+
+    // Split the tracks exactly.
+    std::vector<size_t> order(tracks.size());
+    std::iota(order.begin(), order.end(), 0);
+    const Sides sides{tracks, std::move(order), partitioner.split(optimum)};
+
+    if (showDebug)
+    {
+        std::cout << "\nBalanced sides\n";
+        for (const auto & side : sides)
+            std::cout << side.getTitle() << " - " << side.size() << " tracks " << secondsToTimeString(side.getValue()) << "\n";
+        std::cout << "Deviation " << deviation(sides) << "\n";
+    }
+
+    showSides(sides, "The recommended sides are");
 
     return 0;
 }
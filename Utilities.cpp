@@ -28,6 +28,10 @@
 #include <vector>
 #include <thread>
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 #include "Side.h"
 #include "Utilities.h"
 #include "TextFile.h"
@@ -68,6 +72,37 @@ size_t timeStringToSeconds(std::string buffer)
 }
 
 
+/**
+ * @brief Break a time string (H:M:S) with optional fractional seconds down to
+ * get total number of milliseconds. Also handles M:S and S formats, so "1:30",
+ * "90" and "90.0" are all 90000 milliseconds, and "0.25" is 250.
+ * 
+ * @param buffer time string to parse.
+ * @return size_t the equivalent number of milliseconds.
+ */
+size_t timeStringToMilliseconds(std::string buffer)
+{
+    size_t milliseconds{};
+    const auto pos{buffer.find('.')};
+    if (pos != std::string::npos)
+    {
+        std::string fraction{buffer.substr(pos + 1, 3)};
+        const auto length{fraction.find_first_not_of(digit)};
+        if (length != std::string::npos)
+            fraction.resize(length);
+        if (!fraction.empty())
+        {
+            fraction.resize(3, '0');
+            milliseconds = std::stoi(fraction);
+        }
+
+        buffer.resize(pos);
+    }
+
+    return timeStringToSeconds(buffer) * 1000 + milliseconds;
+}
+
+
 /**
  * @brief Generates a time string in the form H:M:S from the given seconds.
  * 
@@ -96,6 +131,25 @@ std::string secondsToTimeString(size_t seconds, const std::string & sep)
     return ss.str();
 }
 
+/**
+ * @brief Generates a time string in the form H:M:S.mmm from the given
+ * milliseconds.
+ * 
+ * @param milliseconds number of milliseconds to represent.
+ * @return std::string time string in the form H:M:S.mmm.
+ */
+std::string millisecondsToTimeString(size_t milliseconds)
+{
+    std::ostringstream ss;
+
+    ss << secondsToTimeString(milliseconds / 1000) << '.';
+    ss.width(3);
+    ss.fill('0');
+    ss << milliseconds % 1000;
+
+    return ss.str();
+}
+
 /**
  * @brief Builds a vector of Tracks from the input file.
  * 
@@ -117,61 +171,239 @@ std::vector<Track> buildTrackListFromInputFile(const std::filesystem::path & inp
 
 
 /**
- * @section Define Timer class.
+ * @section Load kernels.
  *
+ * The sum and sum of squares of an array of side lengths, used to score a set
+ * of sides. The AVX2 and SSE2 versions multiply the low 32 bits of each length,
+ * so lengths must be below 2^32 seconds. The fastest version the processor
+ * supports is chosen once at start up.
  */
 
-void Timer::waiter(void)
-{
-    using namespace std::literals::chrono_literals;
+using LoadKernel = void (*)(const size_t *, size_t, size_t &, size_t &);
 
-    while (true)
+/**
+ * @brief Calculate the sum and sum of squares of an array of side lengths one
+ * at a time. This is the fallback, and the reference the others are measured
+ * against.
+ * 
+ * @param loads array of side lengths.
+ * @param count number of side lengths.
+ * @param sum of the side lengths.
+ * @param squares sum of the squares of the side lengths.
+ */
+void sumLoadsScalar(const size_t * loads, size_t count, size_t & sum, size_t & squares)
+{
+    // Accumulate locally, as the outputs could alias the loads.
+    size_t total{};
+    size_t sumSquares{};
+    for (size_t i = 0; i < count; ++i)
     {
-        std::this_thread::sleep_for(1s);
+        total += loads[i];
+        sumSquares += loads[i] * loads[i];
+    }
+
+    sum = total;
+    squares = sumSquares;
+}
+
+// The vector kernels load each side length as a 64 bit lane, so they are only
+// built where size_t is 64 bits wide.
+#if defined(__x86_64__)
 
-        std::lock_guard<std::mutex> lock(counterMutex);
-        if (!working)
+static_assert(sizeof(size_t) == sizeof(uint64_t));
+
+__attribute__((target("sse2")))
+static void sumLoadsSSE2(const size_t * loads, size_t count, size_t & sum, size_t & squares)
+{
+    __m128i sums[2]{_mm_setzero_si128(), _mm_setzero_si128()};
+    __m128i squared[2]{_mm_setzero_si128(), _mm_setzero_si128()};
+
+    size_t i{};
+    for (; i + 4 <= count; i += 4)
+    {
+        for (int j = 0; j < 2; ++j)
         {
-            // std::cout << "Aborting!\n";
-            break;
+            const __m128i value{_mm_loadu_si128((const __m128i *)(loads + i + 2 * j))};
+            sums[j] = _mm_add_epi64(sums[j], value);
+            squared[j] = _mm_add_epi64(squared[j], _mm_mul_epu32(value, value));
         }
+    }
+
+    alignas(16) uint64_t lanes[2];
+    _mm_store_si128((__m128i *)lanes, _mm_add_epi64(sums[0], sums[1]));
+    size_t total{lanes[0] + lanes[1]};
+    _mm_store_si128((__m128i *)lanes, _mm_add_epi64(squared[0], squared[1]));
+    size_t sumSquares{lanes[0] + lanes[1]};
+
+    for (; i < count; ++i)
+    {
+        total += loads[i];
+        sumSquares += loads[i] * loads[i];
+    }
+
+    sum = total;
+    squares = sumSquares;
+}
 
-        if (--counter <= 0)
+__attribute__((target("avx2")))
+static void sumLoadsAVX2(const size_t * loads, size_t count, size_t & sum, size_t & squares)
+{
+    __m256i sums[2]{_mm256_setzero_si256(), _mm256_setzero_si256()};
+    __m256i squared[2]{_mm256_setzero_si256(), _mm256_setzero_si256()};
+
+    size_t i{};
+    for (; i + 8 <= count; i += 8)
+    {
+        for (int j = 0; j < 2; ++j)
         {
-            // std::cout << "Done waiting\n";
-            working = false;
-            break;
+            const __m256i value{_mm256_loadu_si256((const __m256i *)(loads + i + 4 * j))};
+            sums[j] = _mm256_add_epi64(sums[j], value);
+            squared[j] = _mm256_add_epi64(squared[j], _mm256_mul_epu32(value, value));
         }
+    }
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256((__m256i *)lanes, _mm256_add_epi64(sums[0], sums[1]));
+    size_t total{lanes[0] + lanes[1] + lanes[2] + lanes[3]};
+    _mm256_store_si256((__m256i *)lanes, _mm256_add_epi64(squared[0], squared[1]));
+    size_t sumSquares{lanes[0] + lanes[1] + lanes[2] + lanes[3]};
+
+    for (; i < count; ++i)
+    {
+        total += loads[i];
+        sumSquares += loads[i] * loads[i];
+    }
+
+    sum = total;
+    squares = sumSquares;
+}
+
+#endif
+
+/**
+ * @brief Choose the fastest load kernel the processor supports.
+ * 
+ * @param name of the kernel chosen.
+ * @return LoadKernel the kernel chosen.
+ */
+static LoadKernel selectLoadKernel(const char * & name)
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        name = "avx2";
+        return sumLoadsAVX2;
+    }
 
-        // std::cout << counter << "\n";
+    if (__builtin_cpu_supports("sse2"))
+    {
+        name = "sse2";
+        return sumLoadsSSE2;
     }
+#endif
+
+    name = "scalar";
+    return sumLoadsScalar;
+}
+
+static const char * loadKernelName{};
+static const LoadKernel loadKernel{selectLoadKernel(loadKernelName)};
+
+/**
+ * @brief Calculate the sum and sum of squares of an array of side lengths.
+ * 
+ * @param loads array of side lengths, each below 2^32.
+ * @param count number of side lengths.
+ * @param sum of the side lengths.
+ * @param squares sum of the squares of the side lengths.
+ */
+void sumLoads(const size_t * loads, size_t count, size_t & sum, size_t & squares)
+{
+    loadKernel(loads, count, sum, squares);
+}
+
+/**
+ * @brief Get the name of the load kernel in use.
+ * 
+ * @return const char * either "avx2", "sse2" or "scalar".
+ */
+const char * getLoadKernel(void)
+{
+    return loadKernelName;
+}
+
+/**
+ * @brief Calculate the standard deviation of a list of side lengths. The
+ * variance is found exactly in integers before the one division and square
+ * root.
+ * 
+ * @param loads list of side lengths.
+ * @return double the calculated the standard deviation.
+ */
+double deviation(const std::vector<size_t> & loads)
+{
+    const size_t count{loads.size()};
+    if (count == 0)
+        return 0.0;
+
+    size_t sum{};
+    size_t squares{};
+    sumLoads(loads.data(), count, sum, squares);
+
+    return std::sqrt((double)(count * squares - sum * sum)) / count;
+}
+
+
+/**
+ * @section Define Timer class.
+ *
+ */
+
+void Timer::waiter(void)
+{
+    std::unique_lock<std::mutex> lock(alarmMutex);
+    while ((!cancelled) && (Clock::now() < deadline))
+        alarm.wait_until(lock, deadline);
+
+    working.store(false, std::memory_order_relaxed);
 }
 
 void Timer::start(void)
 {
-    // std::cout << "starting\n";
+    terminate();
+
     {
-        std::lock_guard<std::mutex> lock(counterMutex);
+        std::lock_guard<std::mutex> lock(alarmMutex);
+        deadline = Clock::now() + std::chrono::milliseconds(duration);
+        cancelled = false;
+        working.store(true, std::memory_order_relaxed);
+    }
+    cyberdyne = std::thread(&Timer::waiter, this);
+}
 
-        // std::cout << "Go!\n";
-        counter = duration;
-        working = true;
+/**
+ * @brief Restart the countdown from now.
+ */
+void Timer::reset(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(alarmMutex);
+        deadline = Clock::now() + std::chrono::milliseconds(duration);
     }
-    cyberdyne = std::async(std::launch::async, &Timer::waiter, this);
-    // std::cout << "Done starting\n";
+    alarm.notify_all();
 }
 
 void Timer::terminate(void)
 {
-    // std::cout << "terminating\n";
-    std::lock_guard<std::mutex> lock(counterMutex);
-    working = false;
-    counter = 1;
-
-    using namespace std::literals::chrono_literals;
-    if (cyberdyne.valid())
     {
-        // std::cout << "waiting for thread\n\n\n";
-        cyberdyne.wait_for(1s);
+        std::lock_guard<std::mutex> lock(alarmMutex);
+        cancelled = true;
     }
+    alarm.notify_all();
+
+    if (cyberdyne.joinable())
+        cyberdyne.join();
+
+    working.store(false, std::memory_order_relaxed);
 }
@@ -44,9 +44,16 @@ extern const std::string whitespace;
 extern const std::string digit;
 
 extern size_t timeStringToSeconds(std::string buffer);
+extern size_t timeStringToMilliseconds(std::string buffer);
 extern std::string secondsToTimeString(size_t seconds, const std::string & sep = ":");
+extern std::string millisecondsToTimeString(size_t milliseconds);
 extern std::vector<Track> buildTrackListFromInputFile(const std::filesystem::path & inputFile);
 
+extern void sumLoadsScalar(const size_t * loads, size_t count, size_t & sum, size_t & squares);
+extern void sumLoads(const size_t * loads, size_t count, size_t & sum, size_t & squares);
+extern const char * getLoadKernel(void);
+extern double deviation(const std::vector<size_t> & loads);
+
 /**
  * @brief Calculate the standard deviation of the lengths of the given list of
  * sides.
@@ -57,51 +64,54 @@ extern std::vector<Track> buildTrackListFromInputFile(const std::filesystem::pat
 template<typename T=Side, typename C=std::vector<T>>
 double deviation(const C & list)
 {
-    // Calculate total play time.
-    auto lambdaSum = [](size_t a, const T & b) { return a + b.getValue(); };
-    size_t total = std::accumulate(list.begin(), list.end(), 0, lambdaSum);
-    // std::cout << "total " << total << "\n";
-
-    double mean{(double)total / list.size()};
-    // std::cout << "mean " << mean << "\n";
+    std::vector<size_t> loads{};
+    loads.reserve(list.size());
+    for (const auto & item : list)
+        loads.push_back(item.getValue());
 
-    auto lambdaVariance = [mean](double a, const T & b) { return a + std::pow((mean - b.getValue()), 2); };
-    double variance = std::accumulate(list.begin(), list.end(), 0.0, lambdaVariance);
-    // std::cout << "variance " << variance << "\n";
-    variance /= list.size();
-    // std::cout << "variance " << variance << "\n";
-
-    return std::sqrt(variance);
+    return deviation(loads);
 }
 
 /**
  * @section Define Timer class.
  *
+ * Timer provides a cancellable deadline with millisecond resolution. A waiter
+ * thread sleeps on a condition variable until either the deadline passes or
+ * the Timer is terminated, so terminating returns immediately. The working
+ * flag is atomic, so it can be checked cheaply from any thread in hot loops.
  */
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
-#include <future>
+#include <condition_variable>
+#include <thread>
 
 class Timer
 {
 public:
-    Timer(size_t init) : working{}, duration{init}, counter{init} {}
+    using Clock = std::chrono::steady_clock;
+
+    Timer(size_t init) : working{}, cancelled{}, duration{init}, deadline{} {}
+    ~Timer(void) { terminate(); }
 
     void start(void);
     void terminate(void);
 
-    void set(size_t init) { std::lock_guard<std::mutex> lock(counterMutex); duration = init; counter = init; }
-    void reset(void) { std::lock_guard<std::mutex> lock(counterMutex); counter = duration; }
-    bool isWorking(void) const { std::lock_guard<std::mutex> lock(counterMutex); return working; }
+    void set(size_t init) { std::lock_guard<std::mutex> lock(alarmMutex); duration = init; }
+    void reset(void);
+    bool isWorking(void) const { return working.load(std::memory_order_relaxed); }
 
 private:
     void waiter(void);
 
-    bool working;
+    std::atomic<bool> working;
+    bool cancelled;
     size_t duration;
-    size_t counter;
-    mutable std::mutex counterMutex;
-    std::future<void> cyberdyne;
+    Clock::time_point deadline;
+    std::mutex alarmMutex;
+    std::condition_variable alarm;
+    std::thread cyberdyne;
 
 };
 